@@ -0,0 +1,66 @@
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file compile_time.cpp
+*
+* Compile time benchmark: instantiates a heterogeneous::vector of
+* HETEROGENEOUS_BENCH_LANES distinct element types and the operations
+* applications typically use on it. Built by compile_time.sh, which
+* reports the build time and object size for several lane counts.
+*/
+
+#include <cstddef>
+#include <iostream>
+#include <utility>
+
+#include "heterogeneous.hpp"
+
+#ifndef HETEROGENEOUS_BENCH_LANES
+#define HETEROGENEOUS_BENCH_LANES 10
+#endif
+
+// a distinct element type per lane
+template<size_t I>
+struct column
+{
+    double value;
+
+    bool operator==(const column& rhs) const { return value == rhs.value; }
+    bool operator<(const column& rhs) const { return value < rhs.value; }
+};
+
+template<size_t... I>
+heterogeneous::vector<column<I>...> make_record(std::index_sequence<I...>);
+
+typedef decltype(make_record(std::make_index_sequence<HETEROGENEOUS_BENCH_LANES>())) record;
+
+template<size_t... I>
+void fill(record& hv, std::index_sequence<I...>)
+{
+    for (size_t row = 0; row < 4; ++row) hv.push_back(column<I>{ static_cast<double>(row + I) }...);
+    hv.insert_row(0, column<I>{ -1.0 }...);
+}
+
+int main()
+{
+    record hv;
+    fill(hv, std::make_index_sequence<HETEROGENEOUS_BENCH_LANES>());
+
+    record copy(hv);
+    copy.get<column<HETEROGENEOUS_BENCH_LANES - 1> >()[0].value = 1.0;
+
+    size_t elements = 0;
+    hv.for_each([&elements](const auto& c) { elements += c.size(); });
+    hv.for_each(copy, [](auto& c, auto& x) { c.swap(x); });
+
+    const bool ordered = hv.all_of([](const auto& c) { return !c.empty(); }) && !(hv == copy) && copy.lte(hv);
+
+    std::cout << record::size_v << " lanes, " << elements << " elements, " << ordered << " " << hv.type<HETEROGENEOUS_BENCH_LANES / 2>().name() << std::endl;
+    return 0;
+}
@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE_1_0.txt or copy at
+# http://www.boost.org/LICENSE_1_0.txt)
+#
+# Builds compile_time.cpp for 10, 50 and 200 lanes, or for the lane counts
+# given as arguments, and reports the build time and object size of each.
+#
+# Environment:
+#   CXX       compiler, default c++
+#   CXXFLAGS  flags, default -std=c++14 -O2
+#   INCLUDES  include flags, default the repository include directory;
+#             must also locate boost/any.hpp if it is not installed
+
+cd "$(dirname "$0")" || exit 1
+
+CXX=${CXX:-c++}
+CXXFLAGS=${CXXFLAGS:--std=c++14 -O2}
+INCLUDES=${INCLUDES:--I../include}
+OUT=${TMPDIR:-/tmp}/heterogeneous_compile_time.o
+
+[ $# -eq 0 ] && set -- 10 50 200
+
+printf '%8s %12s %14s\n' lanes seconds object_bytes
+for lanes in "$@"
+do
+    start=$(date +%s.%N)
+    $CXX $CXXFLAGS $INCLUDES -DHETEROGENEOUS_BENCH_LANES="$lanes" -c compile_time.cpp -o "$OUT" || exit 1
+    end=$(date +%s.%N)
+
+    printf '%8s %12.2f %14s\n' "$lanes" "$(awk "BEGIN { print $end - $start }")" "$(wc -c < "$OUT" | tr -d ' ')"
+done
+
+rm -f "$OUT"
@@ -0,0 +1,92 @@
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file skewed.cpp
+*
+* Skewed workload benchmark: one container of a heterogeneous::vector
+* holds many more elements than the others. Times the same element-wise
+* work done sequentially, with one task per container, and with
+* for_each_chunk(), which splits containers into ranges balanced across
+* threads by work stealing; then times take() over a vector of two large
+* containers, sequentially and with par.
+*
+* Usage: skewed [large elements, default 20000000] [small elements, default 4096]
+*
+*     c++ -std=c++14 -O2 -pthread -I../include skewed.cpp -o skewed
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/parallel.hpp"
+#include "heterogeneous/rows.hpp"
+#include "heterogeneous/transform.hpp"
+
+// enough arithmetic per element for the work, not memory, to dominate
+template<typename C>
+void work(C& c, size_t first, size_t last)
+{
+    for (size_t i = first; i < last; ++i) c[i] = static_cast<typename C::value_type>(std::sqrt(c[i] * c[i] + 1.0) * 0.5);
+}
+
+template<typename Function>
+double seconds(Function fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    const size_t large = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000;
+    const size_t small = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4096;
+
+    heterogeneous::vector<double, float, int, long> hv;
+    hv.get<double>().assign(large, 1.5);
+    hv.get<float>().assign(small, 1.5f);
+    hv.get<int>().assign(small, 3);
+    hv.get<long>().assign(small, 3);
+
+    std::cout << "threads " << std::thread::hardware_concurrency() << ", elements " << large << " + 3 x " << small << std::endl;
+
+    std::cout << "sequential        " << seconds([&hv]()
+    {
+        hv.for_each([](auto& C) { work(C, 0, C.size()); });
+    }) << " s" << std::endl;
+
+    std::cout << "task per lane     " << seconds([&hv]()
+    {
+        heterogeneous::transform_lanes(hv, heterogeneous::par, [](auto& C) { work(C, 0, C.size()); return 0; });
+    }) << " s" << std::endl;
+
+    std::cout << "for_each_chunk    " << seconds([&hv]()
+    {
+        heterogeneous::for_each_chunk(hv, heterogeneous::par, [](auto& C, size_t first, size_t last) { work(C, first, last); });
+    }) << " s" << std::endl;
+
+    heterogeneous::vector<double, long> rows;
+    rows.get<double>().assign(large, 2.5);
+    rows.get<long>().assign(large, 7);
+
+    std::mt19937_64 rng(1);
+    std::vector<size_t> indices(large);
+    for (auto& i : indices) i = rng() % large;
+
+    std::cout << "take, seq         " << seconds([&]() { heterogeneous::take(rows, indices); }) << " s" << std::endl;
+    std::cout << "take, par         " << seconds([&]() { heterogeneous::take(rows, indices, heterogeneous::par); }) << " s" << std::endl;
+
+    return 0;
+}
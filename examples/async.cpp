@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/async.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    heterogeneous::vector<int, double, std::string, double> hv;
+    for (int i = 0; i < 1000; ++i) hv.push_back(i, i * 0.5, std::to_string(i), 1.0);
+    heterogeneous::thread_pool pool(4);
+
+    heterogeneous::async_for_each(hv, pool, [](auto& c) { std::reverse(c.begin(), c.end()); }).wait();
+    CHECK(hv.get<int>()[0] == 999 && hv.get<std::string>()[0] == "999");
+
+    auto all = heterogeneous::async_all_of(hv, pool, [](const auto& c) { return c.size() == 1000; });
+    auto none = heterogeneous::async_none_of(hv, pool, [](const auto& c) { return c.empty(); });
+    CHECK(all.get() && none.get());
+
+    // results combined in container order
+    auto sizes = heterogeneous::async_transform_reduce_lanes(hv, pool, std::string(), [](std::string a, size_t n) { return a + std::to_string(n) + ","; }, [](const auto& c) { return c.size(); });
+    CHECK(sizes.get() == "1000,1000,1000,1000,");
+
+    // continuations run as results arrive, on the pool or inline
+    auto sum = heterogeneous::async_reduce<int>(hv, pool, 0).then(pool, [](int s) { return s * 2; }).then([](int s) { return std::to_string(s); });
+    CHECK(sum.get() == "999000");
+    CHECK(heterogeneous::async_reduce<double, 1>(hv, pool, 0.0).get() == 1000.0);
+
+    // an exception skips the continuations and reaches get()
+    bool called = false;
+    auto failed = heterogeneous::async_all_of(hv, pool, [](const auto& c) -> bool { if (c.size() > 0) throw std::runtime_error("failed"); return true; })
+        .then(pool, [&called](bool b) { called = true; return b; });
+    CHECK_THROWS(failed.get(), std::runtime_error);
+    CHECK(!called);
+
+    heterogeneous::inline_executor inline_executor;
+    auto reduced = heterogeneous::async_reduce<int>(hv, inline_executor, 0);
+    CHECK(reduced.is_ready() && reduced.get() == 499500 && !reduced.valid());
+
+    heterogeneous::promise<int> p;
+    auto chain = p.get_future().then(pool, [](int x) { return x + 1; }).then(pool, [](int x) { return x * 10; });
+    p.set_value(4);
+    CHECK(chain.get() == 50);
+    CHECK_THROWS(p.set_value(5), std::logic_error);
+
+    // a promise destroyed unsatisfied breaks its future and continuations instead of leaving them waiting
+    heterogeneous::future<int> orphan, orphan_chain;
+    {
+        heterogeneous::promise<int> broken;
+        heterogeneous::promise<int> copy = broken;
+        orphan = broken.get_future();
+        orphan_chain = orphan.then(pool, [](int x) { return x + 1; });
+    }
+    CHECK_THROWS(orphan_chain.get(), std::future_error);
+
+    heterogeneous::future<void> orphan_void;
+    {
+        heterogeneous::promise<void> broken;
+        orphan_void = broken.get_future();
+    }
+    CHECK(orphan_void.is_ready());
+    bool broken_promise = false;
+    try
+    {
+        orphan_void.get();
+    }
+    catch (const std::future_error& e)
+    {
+        broken_promise = e.code() == std::future_errc::broken_promise;
+    }
+    CHECK(broken_promise);
+
+    // many short chains, each completing on a pool thread
+    long long total = 0;
+    for (int k = 0; k < 2000; ++k)
+        total += heterogeneous::async_transform_reduce_lanes(hv, pool, 0LL, std::plus<long long>(), [](const auto& c) { return static_cast<long long>(c.size()); }).then(pool, [](long long x) { return x; }).get();
+    CHECK(total == 2000LL * 4000);
+
+    return examples::report("async");
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/bloom_filter.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    heterogeneous::vector<int, std::string> hv;
+    for (int i = 0; i < 200000; i += 2) hv.get<int>().push_back(i);
+
+    auto bf = heterogeneous::make_bloom_filter<int>(hv, 0.01);
+
+    // no false negatives
+    bool all = true;
+    for (int i = 0; i < 200000; i += 2) all = all && bf.might_contain(i);
+    CHECK(all);
+
+    // false positives near the requested rate
+    size_t positives = 0;
+    for (int i = 1; i < 200000; i += 2) positives += bf.might_contain(i) ? 1 : 0;
+    CHECK(positives < 100000 / 25);
+
+    // appends are absorbed, growing the filter as needed
+    for (int i = 200000; i < 1000000; ++i) hv.get<int>().push_back(i);
+    all = true;
+    for (int i = 200000; i < 1000000; i += 7) all = all && bf.might_contain(i);
+    CHECK(all);
+
+    hv.get<std::string>().push_back("hello");
+    auto bs = heterogeneous::make_bloom_filter<std::string>(hv);
+    CHECK(bs.might_contain("hello"));
+
+    // rewriting in place and advancing the generation rebuilds the filter
+    hv.get<std::string>()[0] = "world";
+    hv.touch();
+    CHECK(bs.might_contain("world"));
+    CHECK(!bs.might_contain("hello"));
+
+    auto copy = bf;
+    CHECK(copy.might_contain(4));
+
+    CHECK_THROWS(heterogeneous::make_bloom_filter<int>(hv, 1.5), std::invalid_argument);
+
+    return examples::report("bloom_filter");
+}
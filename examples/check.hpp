@@ -0,0 +1,60 @@
+#ifndef HETEROGENEOUS_EXAMPLES_CHECK
+#define HETEROGENEOUS_EXAMPLES_CHECK
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file check.hpp
+*
+* Checks used by the examples, which double as smoke tests: unlike
+* assert(), a check is never compiled out, reports the failing expression
+* and lets the example go on. An example returns report(), which is
+* nonzero if any check failed.
+*/
+
+#include <iostream>
+
+namespace examples
+{
+    inline int& failures()
+    {
+        static int n = 0;
+        return n;
+    }
+
+    inline void check(bool ok, const char* expression, const char* file, int line)
+    {
+        if (ok) return;
+
+        std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+        ++failures();
+    }
+
+    /*!
+    * \brief Prints a summary and returns the exit status of the example.
+    */
+    inline int report(const char* example)
+    {
+        std::cout << example << (failures() == 0 ? ": ok" : ": FAILED") << std::endl;
+        return failures() == 0 ? 0 : 1;
+    }
+}
+
+// variadic, so that commas of template arguments need no extra parentheses
+#define CHECK(...) examples::check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expression, exception) \
+    do \
+    { \
+        bool thrown = false; \
+        try { (void)(expression); } catch (const exception&) { thrown = true; } \
+        examples::check(thrown, #expression " throws " #exception, __FILE__, __LINE__); \
+    } while (false)
+
+#endif // HETEROGENEOUS_EXAMPLES_CHECK
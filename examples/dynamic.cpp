@@ -0,0 +1,63 @@
+#include <iostream>
+#include <string>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include "heterogeneous/dynamic.hpp"
+
+#include "check.hpp"
+
+template<int I>
+struct point
+{
+    int v;
+};
+
+int main()
+{
+    heterogeneous::dynamic_vector dv;
+    dv.add<int>().push_back(3);
+    dv.add<std::string>().push_back("x");
+    dv.add<int>().push_back(4);
+    CHECK(dv.size() == 2 && dv.get<int>() == std::vector<int>{ 3, 4 });
+    CHECK(!dv.contains<double>() && dv.contains<std::string>() && dv.size(typeid(std::string)) == 1);
+
+    // a handle stays valid as containers are added and the table grows
+    auto ints = dv.get_handle<int>();
+    dv.add<point<0> >();
+    dv.add<point<1> >();
+    dv.add<point<2> >();
+    dv.add<point<3> >();
+    dv.add<point<4> >();
+    dv.add<point<5> >();
+    dv.add<point<6> >().push_back({ 7 });
+    dv.add<double>();
+    ints->push_back(5);
+    CHECK(dv.size() == 10 && dv.get<int>().size() == 3 && dv.get<point<6> >()[0].v == 7);
+
+    // copies are deep
+    heterogeneous::dynamic_vector copy = dv;
+    copy.get<int>().push_back(1);
+    CHECK(dv.get<int>().size() == 3 && copy.get<int>().size() == 4);
+
+    // removal keeps the other containers, their order and their handles
+    CHECK(dv.remove<point<3> >() && !dv.remove<point<3> >());
+    CHECK(dv.size() == 9 && dv.contains<point<4> >() && !dv.contains<point<3> >() && ints->size() == 3);
+    const std::vector<std::type_index> types = dv.types();
+    CHECK(types.size() == 9 && types[0] == typeid(int) && types[1] == typeid(std::string) && types.back() == typeid(double));
+
+    CHECK_THROWS(dv.get<point<3> >(), std::invalid_argument);
+    CHECK_THROWS(dv.size(typeid(point<3>)), std::invalid_argument);
+
+    const heterogeneous::dynamic_vector& constant = dv;
+    CHECK(constant.get<std::string>()[0] == "x" && constant.size(typeid(int)) == 3);
+
+    dv.clear();
+    CHECK(dv.size() == 9 && dv.get<int>().empty() && dv.get<point<6> >().empty());
+
+    heterogeneous::dynamic_vector moved = std::move(copy);
+    CHECK(moved.size() == 10 && moved.get<int>().size() == 4 && copy.size() == 0 && !copy.contains<int>());
+
+    return examples::report("dynamic");
+}
@@ -0,0 +1,49 @@
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/expression.hpp"
+
+#include "check.hpp"
+
+using heterogeneous::expr;
+
+int main()
+{
+    heterogeneous::vector<double, double, double, double, int> hv;
+    const size_t n = 100000;
+    for (size_t i = 0; i < n; ++i)
+    {
+        hv.get<double, 0>().push_back(static_cast<double>(i));
+        hv.get<double, 1>().push_back(2.0);
+        hv.get<double, 2>().push_back(1.0);
+        hv.get<int>().push_back(3);
+    }
+
+    // one fused loop, no temporaries
+    const size_t generation = hv.generation();
+    heterogeneous::assign<double, 3>(hv, expr<double, 0>(hv) * expr<double, 1>(hv) + expr<double, 2>(hv));
+    CHECK(hv.get<double, 3>()[10] == 21.0);
+    CHECK(hv.generation() != generation);
+
+    // split across threads with par, in place
+    heterogeneous::assign(hv.get<double, 3>(), -expr(hv.get<double, 3>()) / 2.0 + 1, heterogeneous::par);
+    CHECK(hv.get<double, 3>()[10] == -9.5);
+    CHECK(hv.get<double, 3>()[n - 1] == -(2.0 * (n - 1) + 1) / 2.0 + 1);
+
+    auto mapped = heterogeneous::evaluate(heterogeneous::map(expr<int>(hv), [](int x) { return std::sqrt(x * 3.0); }) * expr<double, 1>(hv), heterogeneous::par);
+    CHECK(mapped.size() == n);
+    CHECK(mapped[0] == 6.0);
+
+    // element type follows the usual arithmetic conversions
+    auto doubled = heterogeneous::evaluate(2 * expr<int>(hv));
+    CHECK(std::is_same<decltype(doubled), std::vector<int> >::value);
+    CHECK(doubled[7] == 6);
+
+    std::vector<double> shorter(3);
+    CHECK_THROWS(heterogeneous::assign(shorter, expr(shorter) + expr<double>(hv)), std::invalid_argument);
+
+    return examples::report("expression");
+}
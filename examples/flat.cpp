@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/flat.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    heterogeneous::vector<long, std::string, double> hv;
+    std::vector<long>& a = hv.get<long>();
+    std::mt19937_64 rng(5);
+    for (int i = 0; i < 1000; ++i) a.push_back(static_cast<long>(rng() % 5000));
+
+    // the container itself becomes the sorted set
+    auto set = heterogeneous::make_flat_set<long>(hv);
+    std::set<long> expected(a.begin(), a.end());
+    CHECK(std::vector<long>(expected.begin(), expected.end()) == a);
+
+    bool inserted = true;
+    for (int r = 0; r < 50; ++r)
+    {
+        std::vector<long> batch;
+        for (int i = 0; i < 200; ++i) batch.push_back(static_cast<long>(rng() % 100000));
+        const size_t before = expected.size();
+        expected.insert(batch.begin(), batch.end());
+        inserted = inserted && set.insert(batch.begin(), batch.end()) == expected.size() - before;
+    }
+    CHECK(inserted && std::vector<long>(expected.begin(), expected.end()) == a);
+
+    // every search finds the same position, absent keys and keys out of range included
+    bool found = true;
+    for (int q = 0; q < 20000; ++q)
+    {
+        const long k = static_cast<long>(rng() % 110000) - 5000;
+        const size_t lb = std::lower_bound(a.begin(), a.end(), k) - a.begin();
+        found = found && set.lower_bound(k) == lb && set.lower_bound(k, heterogeneous::eytzinger) == lb && set.lower_bound(k, heterogeneous::interpolation) == lb;
+        found = found && set.contains(k) == (expected.count(k) > 0) && set.contains(k, heterogeneous::eytzinger) == (expected.count(k) > 0);
+    }
+    CHECK(found);
+
+    // the Eytzinger layout follows inserts and erases
+    const long fifth = a[5];
+    CHECK(set.insert(42).second == (expected.count(42) == 0) && !set.insert(42).second && set.erase(fifth) && !set.erase(fifth));
+    expected.insert(42);
+    expected.erase(fifth);
+    CHECK(std::vector<long>(expected.begin(), expected.end()) == a);
+    CHECK(set.find(42, heterogeneous::eytzinger) == static_cast<size_t>(std::distance(expected.begin(), expected.find(42))));
+    CHECK(set.find(fifth, heterogeneous::eytzinger) == a.size());
+
+    // interpolation search on skewed keys
+    std::vector<double> skewed;
+    for (int i = 0; i < 100000; ++i) skewed.push_back(std::exp(i / 5000.0));
+    heterogeneous::flat_set<double> skewed_set(skewed);
+    bool interpolated = true;
+    for (int q = 0; q < 20000; ++q)
+    {
+        const double k = std::exp((rng() % 100000) / 5000.0) + (q & 1 ? 0.5 : 0);
+        interpolated = interpolated && skewed_set.lower_bound(k, heterogeneous::interpolation) == static_cast<size_t>(std::lower_bound(skewed.begin(), skewed.end(), k) - skewed.begin());
+    }
+    CHECK(interpolated);
+
+    // infinite and huge keys make the interpolated position meaningless; those steps bisect instead
+    std::vector<double> extremes = { -INFINITY, -1e308 };
+    for (int i = 0; i < 1000; ++i) extremes.push_back(i);
+    extremes.push_back(1e308);
+    extremes.push_back(INFINITY);
+    heterogeneous::flat_set<double> extreme_set(extremes);
+    bool bounded = true;
+    for (double k : std::vector<double>{ -INFINITY, -1e308, -1.0, 0.0, 500.5, 999.0, 1e308, INFINITY })
+        bounded = bounded && extreme_set.lower_bound(k, heterogeneous::interpolation) == static_cast<size_t>(std::lower_bound(extremes.begin(), extremes.end(), k) - extremes.begin());
+    CHECK(bounded);
+
+    // a map over two containers keeps the first entry of each key
+    std::vector<std::string>& keys = hv.get<std::string>();
+    std::vector<double>& values = hv.get<double>();
+    keys = { "b", "a", "b", "c" };
+    values = { 1, 2, 3, 4 };
+    auto map = heterogeneous::make_flat_map<heterogeneous::lane<std::string>, heterogeneous::lane<double> >(hv);
+    CHECK(keys == std::vector<std::string>{ "a", "b", "c" } && values == std::vector<double>{ 2, 1, 4 });
+
+    const std::vector<std::pair<std::string, double> > batch = { { "z", 9 }, { "a", 7 }, { "aa", 5 }, { "d", 6 }, { "aa", 8 } };
+    CHECK(map.insert(batch.begin(), batch.end()) == 3);
+    CHECK(map.insert("0", 0).second && map.erase("c") && !map.contains("c"));
+    CHECK(keys == std::vector<std::string>{ "0", "a", "aa", "b", "d", "z" } && values == std::vector<double>{ 0, 2, 5, 1, 6, 9 });
+    CHECK(map.at("z", heterogeneous::eytzinger) == 9 && map.at("a") == 2);
+    CHECK_THROWS(map.at("q"), std::out_of_range);
+
+    return examples::report("flat");
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/generator.hpp"
+
+#include "check.hpp"
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine) && defined(__cpp_lib_span)
+
+int main()
+{
+    heterogeneous::vector<int, double, std::string, double> hv;
+    for (int i = 0; i < 5; ++i) hv.push_back(i, i * 0.5, std::to_string(i), 10.0 + i);
+
+    // every element, container by container, in place
+    size_t n = 0;
+    std::string strings;
+    bool in_place = true;
+    for (const auto& e : heterogeneous::elements(hv))
+    {
+        ++n;
+        if (e.lane == 2) strings += e.get<std::string>();
+        in_place = in_place && hv.visit_lane(e.lane, [&e](auto& c) { return static_cast<void*>(&c[e.row]) == e.address; });
+    }
+    CHECK(n == 20 && strings == "01234" && in_place);
+    CHECK_THROWS(
+        [&hv]() { for (const auto& e : heterogeneous::elements(hv)) e.get<char>(); }(),
+        std::invalid_argument);
+
+    // elements of the containers of one type are references
+    for (double& d : heterogeneous::elements<double>(hv)) d += 1;
+    CHECK(hv.get<double>() == std::vector<double>{ 1, 1.5, 2, 2.5, 3 } && hv.get<double, 1>()[4] == 15);
+
+    std::string chunks;
+    for (const auto& c : heterogeneous::chunks(hv, 2)) chunks += std::to_string(c.lane) + ":" + std::to_string(c.first) + "-" + std::to_string(c.last) + " ";
+    CHECK(chunks == "0:0-2 0:2-4 0:4-5 1:0-2 1:2-4 1:4-5 2:0-2 2:2-4 2:4-5 3:0-2 3:2-4 3:4-5 ");
+
+    std::string spans;
+    for (auto s : heterogeneous::chunks<std::string>(hv, 3))
+    {
+        for (const auto& x : s) spans += x;
+        spans += "|";
+    }
+    CHECK(spans == "012|34|");
+    CHECK_THROWS(heterogeneous::chunks(hv, 0), std::invalid_argument);
+
+    // adaptors too
+    std::vector<boost::any> any{ 1, std::string("a"), 2, 3.0, 4 };
+    heterogeneous::adaptor<std::vector<boost::any> > adaptor(any);
+    int ints = 0;
+    for (int& x : heterogeneous::elements<int>(adaptor)) ints = ints * 10 + x;
+    CHECK(ints == 124);
+
+    // produced as asked for
+    auto g = heterogeneous::elements<int>(hv);
+    auto it = g.begin();
+    CHECK(*it == 0 && *++it == 1);
+
+    return examples::report("generator");
+}
+
+#else
+
+int main()
+{
+    std::cout << "generator: skipped, requires C++20 coroutines" << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/rows.hpp"
+#include "heterogeneous/zone_map.hpp"
+
+#include "check.hpp"
+
+// keep_rows() with every flag set to flag, on n rows whose double container counts from 0
+template<typename Policy>
+bool keeps_all(size_t n, std::uint8_t flag, Policy policy)
+{
+    heterogeneous::vector<double, int, std::string> hv;
+    for (size_t i = 0; i < n; ++i)
+    {
+        hv.get<double>().push_back(static_cast<double>(i));
+        hv.get<int>().push_back(static_cast<int>(i));
+        hv.get<std::string>().push_back(std::to_string(i));
+    }
+
+    const std::vector<std::uint8_t> keep(n, flag);
+    bool ok = heterogeneous::keep_rows(hv, keep, policy) == n;
+    for (size_t i = 0; i < n; ++i) ok = ok && hv.get<double>()[i] == i && hv.get<int>()[i] == static_cast<int>(i) && hv.get<std::string>()[i] == std::to_string(i);
+    return ok;
+}
+
+int main()
+{
+    // any nonzero flag keeps its row, including those with the high bit set, whatever the number of rows
+    // left over after the last whole SIMD block; the mask holds exactly n flags
+    bool kept = true;
+    for (size_t n = 1; n <= 17; ++n)
+    {
+        for (std::uint8_t flag : { std::uint8_t(1), std::uint8_t(0x7f), std::uint8_t(0x80), std::uint8_t(0xff) })
+            kept = kept && keeps_all(n, flag, heterogeneous::seq) && keeps_all(n, flag, heterogeneous::par);
+    }
+    CHECK(kept);
+
+    {
+        heterogeneous::vector<double, int> hv;
+        for (int i = 0; i < 8; ++i)
+        {
+            hv.get<double>().push_back(i * 1.5);
+            hv.get<int>().push_back(i);
+        }
+        const std::vector<std::uint8_t> keep = { 0x80, 0, 0xff, 0, 0, 0x81, 1, 0 };
+        CHECK(heterogeneous::keep_rows(hv, keep) == 4);
+        CHECK(hv.get<double>() == std::vector<double>{ 0.0, 3.0, 7.5, 9.0 });
+        CHECK(hv.get<int>() == std::vector<int>{ 0, 2, 5, 6 });
+    }
+
+    {
+        heterogeneous::vector<double, std::string> hv;
+        for (int i = 0; i < 9; ++i)
+        {
+            hv.get<double>().push_back(i * 1.0);
+            hv.get<std::string>().push_back(std::to_string(i));
+        }
+        const std::vector<std::uint8_t> keep = { 0, 0xff, 0x80, 0, 0xc0, 0, 0, 0, 0x90 };
+        CHECK(heterogeneous::keep_rows(hv, keep, heterogeneous::par) == 4);
+        CHECK(hv.get<double>() == std::vector<double>{ 1.0, 2.0, 4.0, 8.0 });
+        CHECK(hv.get<std::string>() == std::vector<std::string>{ "1", "2", "4", "8" });
+    }
+
+    // erase_rows_if() keeps every container aligned, those of SIMD compacted elements and the others
+    heterogeneous::vector<int, double, std::string, bool, float, char> hv;
+    const size_t n = 100003;
+    std::mt19937 rng(3);
+    std::vector<int> keys;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int k = static_cast<int>(rng() % 100);
+        keys.push_back(k);
+        hv.get<int>().push_back(k);
+        hv.get<double>().push_back(static_cast<double>(i));
+        hv.get<std::string>().push_back(std::to_string(i));
+        hv.get<bool>().push_back(i % 3 == 0);
+        hv.get<float>().push_back(static_cast<float>(i));
+        hv.get<char>().push_back(static_cast<char>(i));
+    }
+
+    const size_t removed = heterogeneous::erase_rows_if<int>(hv, [](int k) { return k < 30; });
+    CHECK(heterogeneous::rows(hv) + removed == n);
+
+    bool aligned = true;
+    size_t j = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (keys[i] < 30) continue;
+        aligned = aligned && hv.get<int>()[j] == keys[i] && hv.get<double>()[j] == i && hv.get<std::string>()[j] == std::to_string(i)
+            && hv.get<bool>()[j] == (i % 3 == 0) && hv.get<float>()[j] == static_cast<float>(i) && hv.get<char>()[j] == static_cast<char>(i);
+        ++j;
+    }
+    CHECK(aligned && j == heterogeneous::rows(hv));
+
+    heterogeneous::erase_rows_if<bool>(hv, [](bool b) { return b; }, heterogeneous::par);
+    bool none = true;
+    for (bool b : hv.get<bool>()) none = none && !b;
+    CHECK(none);
+
+    CHECK(heterogeneous::erase_rows_if<int>(hv, [](int) { return true; }) > 0 && heterogeneous::rows(hv) == 0);
+
+    CHECK_THROWS(heterogeneous::keep_rows(hv, std::vector<std::uint8_t>(1, 1)), std::invalid_argument);
+
+    // summaries are rebuilt after erasing, even once appends have grown the container past its old size
+    {
+        heterogeneous::vector<int, double> rows;
+        for (int i = 0; i < 50; ++i)
+        {
+            rows.get<int>().push_back(i);
+            rows.get<double>().push_back(i * 1.0);
+        }
+        auto zm = heterogeneous::make_zone_map<int>(rows, 8);
+        CHECK(zm.count(0, 49) == 50);
+
+        heterogeneous::erase_rows_if<int>(rows, [](int k) { return k >= 10; });
+        for (int i = 0; i < 60; ++i)
+        {
+            rows.get<int>().push_back(100 + i);
+            rows.get<double>().push_back(0.0);
+        }
+        CHECK(zm.count(0, 49) == 10);
+        CHECK(zm.count(100, 159) == 60);
+    }
+
+    return examples::report("keep_rows");
+}
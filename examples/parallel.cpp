@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/parallel.hpp"
+#include "heterogeneous/rows.hpp"
+
+#include "check.hpp"
+
+typedef heterogeneous::vector<long, float, std::string> table;
+
+bool same(table& x, table& y)
+{
+    return x.get<long>() == y.get<long>() && x.get<float>() == y.get<float>() && x.get<std::string>() == y.get<std::string>();
+}
+
+int main()
+{
+    // the scheduler behind every par overload calls fn once per index, whatever the size and grain
+    bool covered = true;
+    for (size_t n : { 0, 1, 2, 7, 100, 1000, 100003 })
+    {
+        for (size_t grain : { 1, 3, 64, 5000 })
+        {
+            std::vector<std::atomic<int> > hits(n);
+            for (auto& h : hits) h = 0;
+            heterogeneous::detail::parallel_for(n, grain, [&hits](size_t first, size_t last) { for (size_t i = first; i < last; ++i) ++hits[i]; });
+            for (const auto& h : hits) covered = covered && h == 1;
+        }
+    }
+    CHECK(covered);
+
+    // nested loops run on the threads already busy instead of waiting for free ones
+    std::atomic<long> nested(0);
+    heterogeneous::detail::parallel_for(64, 1, [&nested](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i) heterogeneous::detail::parallel_for(1000, 10, [&nested](size_t a, size_t b) { nested += static_cast<long>(b - a); });
+    });
+    CHECK(nested == 64000);
+
+    // an exception reaches the caller once every range is done
+    int thrown = 0;
+    for (int r = 0; r < 50; ++r)
+    {
+        try
+        {
+            heterogeneous::detail::parallel_for(10000, 7, [](size_t, size_t last) { if (last > 5000) throw std::runtime_error("range"); });
+        }
+        catch (const std::runtime_error&)
+        {
+            ++thrown;
+        }
+    }
+    CHECK(thrown == 50);
+
+    // loops submitted by several threads at once share the pool
+    std::vector<std::thread> threads;
+    std::atomic<long> submitted(0);
+    for (int t = 0; t < 6; ++t)
+    {
+        threads.emplace_back([&submitted]()
+        {
+            for (int r = 0; r < 200; ++r) heterogeneous::detail::parallel_for(5000, 16, [&submitted](size_t first, size_t last) { submitted += static_cast<long>(last - first); });
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(submitted == 6L * 200 * 5000);
+
+    // containers of very different sizes split into ranges covering each once
+    heterogeneous::vector<int, double, std::string> skewed;
+    skewed.get<int>().resize(1000000, 1);
+    skewed.get<double>().resize(3000, 2.0);
+    skewed.get<std::string>().resize(10, "a");
+    std::atomic<long> elements(0), calls(0);
+    heterogeneous::for_each_chunk(skewed, heterogeneous::par, [&](auto&, size_t first, size_t last) { elements += static_cast<long>(last - first); ++calls; }, 1000);
+    CHECK(elements == 1003010 && calls >= 3);
+    heterogeneous::for_each_chunk(skewed, heterogeneous::seq, [&](auto&, size_t first, size_t last) { elements -= static_cast<long>(last - first); --calls; });
+    CHECK(elements == 0);
+
+    // row algorithms give the same result either way
+    table a;
+    const size_t n = 200000;
+    std::mt19937 rng(3);
+    for (size_t i = 0; i < n; ++i) a.push_back(static_cast<long>(i), i * 0.5f, std::to_string(i));
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<size_t> indices(n / 3);
+    for (auto& i : indices) i = rng() % n;
+
+    table t1 = heterogeneous::take(a, indices), t2 = heterogeneous::take(a, indices, heterogeneous::par);
+    CHECK(same(t1, t2));
+
+    table r1 = a, r2 = a;
+    heterogeneous::reorder_rows(r1, order);
+    heterogeneous::reorder_rows(r2, order, heterogeneous::par);
+    CHECK(same(r1, r2));
+
+    std::vector<std::uint8_t> keep(n);
+    for (auto& k : keep) k = rng() % 3 == 0;
+    table k1 = r1, k2 = r1;
+    CHECK(heterogeneous::keep_rows(k1, keep) == heterogeneous::keep_rows(k2, keep, heterogeneous::par) && same(k1, k2));
+
+    table empty = heterogeneous::take(a, std::vector<size_t>(), heterogeneous::par);
+    CHECK(heterogeneous::rows(empty) == 0 && empty.get<std::string>().empty());
+    table none = a;
+    CHECK(heterogeneous::keep_rows(none, std::vector<std::uint8_t>(n, 0), heterogeneous::par) == 0 && none.get<std::string>().empty());
+
+    return examples::report("parallel");
+}
@@ -0,0 +1,34 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+
+#include "heterogeneous.hpp"
+
+#include "check.hpp"
+
+typedef heterogeneous::vector<int, double, std::string, double> table;
+
+// decided at compile time
+static_assert(table::size() == 4 && table::size_v == 4, "");
+static_assert(table::multiplicity<double>() == 2 && table::multiplicity_v<double> == 2, "");
+static_assert(table::multiplicity_v<char> == 0, "");
+static_assert(table::index_of_v<int> == 0 && table::index_of_v<double> == 1 && table::index_of_v<double, 1> == 3, "");
+static_assert(std::is_same<table::type_at_t<2>, std::string>::value && std::is_same<table::type_at_t<3>, double>::value, "");
+
+// taken by reference, which needs their definitions
+size_t larger(const size_t& x, const size_t& y) { return std::max(x, y); }
+
+int main()
+{
+    CHECK(larger(table::size_v, table::multiplicity_v<double>) == 4);
+    CHECK(larger(table::index_of_v<double, 1>, 0) == 3);
+
+    table hv;
+    CHECK(hv.type<0>() == typeid(int) && hv.type<2>() == typeid(std::string) && hv.type<3>() == typeid(double));
+    CHECK(hv.type() == typeid(int));
+    CHECK_THROWS(hv.type<4>(), std::out_of_range);
+
+    return examples::report("queries");
+}
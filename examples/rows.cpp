@@ -0,0 +1,71 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/rows.hpp"
+
+#include "check.hpp"
+
+typedef heterogeneous::vector<int, double, std::string, bool, float, long long> table;
+
+static void push_row(table& t, int i, double d, const std::string& s, bool b, float f, long long l)
+{
+    t.get<int>().push_back(i);
+    t.get<double>().push_back(d);
+    t.get<std::string>().push_back(s);
+    t.get<bool>().push_back(b);
+    t.get<float>().push_back(f);
+    t.get<long long>().push_back(l);
+}
+
+int main()
+{
+    table hv;
+    const size_t n = 100000;
+    for (size_t i = 0; i < n; ++i) push_row(hv, static_cast<int>(i), i * 0.5, std::to_string(i), i % 2 == 1, static_cast<float>(i), -static_cast<long long>(i));
+
+    std::mt19937 rng(2);
+    std::vector<size_t> indices;
+    for (int i = 0; i < 1003; ++i) indices.push_back(rng() % n);
+
+    // every container gathered, 4 and 8 byte ones with SIMD, the others element by element
+    table t = heterogeneous::take(hv, indices);
+    bool gathered = heterogeneous::rows(t) == indices.size();
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        const size_t r = indices[i];
+        gathered = gathered && t.get<int>()[i] == static_cast<int>(r) && t.get<double>()[i] == r * 0.5 && t.get<std::string>()[i] == std::to_string(r)
+            && t.get<bool>()[i] == (r % 2 == 1) && t.get<float>()[i] == static_cast<float>(r) && t.get<long long>()[i] == -static_cast<long long>(r);
+    }
+    CHECK(gathered);
+
+    table t2 = heterogeneous::take(hv, indices, heterogeneous::par);
+    CHECK(t2.get<std::string>() == t.get<std::string>());
+    CHECK(t2.get<long long>() == t.get<long long>());
+    CHECK(t2.get<bool>() == t.get<bool>());
+
+    // gather_into resizes dst, shrinking it too
+    table dst;
+    heterogeneous::gather_into(hv, std::vector<size_t>{ 5, 4, 3 }, dst);
+    CHECK(heterogeneous::rows(dst) == 3 && dst.get<std::string>()[0] == "5");
+    heterogeneous::gather_into(hv, std::vector<size_t>{ 7, 8 }, dst, heterogeneous::par);
+    CHECK(heterogeneous::rows(dst) == 2 && dst.get<std::string>()[1] == "8");
+
+    const size_t generation = hv.generation();
+    heterogeneous::scatter(hv, std::vector<size_t>{ 0, 1 }, dst);
+    CHECK(hv.get<int>()[0] == 7 && hv.get<std::string>()[1] == "8");
+    CHECK(hv.generation() != generation);
+
+    // duplicate indices: the last source row wins
+    table src;
+    push_row(src, -1, 0.0, "first", false, 0.0f, 0);
+    push_row(src, -2, 0.0, "second", false, 0.0f, 0);
+    heterogeneous::scatter(hv, std::vector<size_t>{ 9, 9 }, src);
+    CHECK(hv.get<std::string>()[9] == "second");
+
+    CHECK_THROWS(heterogeneous::take(hv, std::vector<size_t>{ n }), std::out_of_range);
+
+    return examples::report("rows");
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+#
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE_1_0.txt or copy at
+# http://www.boost.org/LICENSE_1_0.txt)
+#
+# Builds and runs every example, or the examples given as arguments, and
+# reports those which fail to build or whose checks fail. Exits with the
+# number of failed examples.
+#
+# Environment:
+#   CXX         compiler, default c++
+#   CXXFLAGS    flags, default -std=c++14 -O2 -pthread
+#   CXX20FLAGS  flags of the examples requiring C++20 (generator.cpp),
+#               default -std=c++20 -O2 -pthread
+#   INCLUDES    include flags, default the repository include directory;
+#               must also locate boost/any.hpp if it is not installed
+
+cd "$(dirname "$0")" || exit 1
+
+CXX=${CXX:-c++}
+CXXFLAGS=${CXXFLAGS:--std=c++14 -O2 -pthread}
+CXX20FLAGS=${CXX20FLAGS:--std=c++20 -O2 -pthread}
+INCLUDES=${INCLUDES:--I../include}
+OUT=${TMPDIR:-/tmp}/heterogeneous_example
+
+[ $# -eq 0 ] && set -- *.cpp
+
+failed=0
+for example in "$@"
+do
+    flags=$CXXFLAGS
+    [ "$example" = generator.cpp ] && flags=$CXX20FLAGS
+
+    if ! $CXX $flags $INCLUDES "$example" -o "$OUT"
+    then
+        echo "$example: does not build"
+        failed=$((failed + 1))
+    elif ! "$OUT" > "$OUT.log" 2>&1
+    then
+        cat "$OUT.log"
+        failed=$((failed + 1))
+    else
+        tail -n 1 "$OUT.log"
+    fi
+done
+
+rm -f "$OUT" "$OUT.log"
+exit $failed
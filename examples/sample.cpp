@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/sample.hpp"
+
+#include "check.hpp"
+
+typedef heterogeneous::vector<int, std::string, bool> table;
+
+// row i of a sample holds the row of hv starting with v, every container alike
+bool aligned(table& t)
+{
+    bool ok = true;
+    for (size_t i = 0; i < heterogeneous::rows(t); ++i)
+    {
+        const int v = t.get<int>()[i];
+        ok = ok && t.get<std::string>()[i] == std::to_string(v) && t.get<bool>()[i] == (v % 2 == 1);
+    }
+    return ok;
+}
+
+void push_row(table& t, int i)
+{
+    t.get<int>().push_back(i);
+    t.get<std::string>().push_back(std::to_string(i));
+    t.get<bool>().push_back(i % 2 == 1);
+}
+
+int main()
+{
+    table hv;
+    for (int i = 0; i < 1000; ++i) push_row(hv, i);
+
+    // every row is drawn about as often, rows stay in their original order
+    std::mt19937_64 rng(42);
+    std::vector<long> hits(1000, 0);
+    bool ordered = true, rows_aligned = true;
+    for (int r = 0; r < 10000; ++r)
+    {
+        table s = heterogeneous::sample_rows(hv, r % 2 ? 10 : 500, rng);
+        const std::vector<int>& a = s.get<int>();
+        ordered = ordered && heterogeneous::rows(s) == (r % 2 ? 10u : 500u) && std::is_sorted(a.begin(), a.end()) && std::adjacent_find(a.begin(), a.end()) == a.end();
+        rows_aligned = rows_aligned && aligned(s);
+        for (int v : a) ++hits[v];
+    }
+    CHECK(ordered && rows_aligned);
+    // 10000 / 2 * (10 + 500) / 1000 draws expected per row
+    CHECK(*std::min_element(hits.begin(), hits.end()) > 2550 * 0.9 && *std::max_element(hits.begin(), hits.end()) < 2550 * 1.1);
+
+    size_t total = 0;
+    for (int r = 0; r < 2000; ++r) total += heterogeneous::bernoulli_sample(hv, 0.05, rng).get<int>().size();
+    CHECK(total > 2000 * 50 * 0.95 && total < 2000 * 50 * 1.05);
+
+    table everything = heterogeneous::bernoulli_sample(hv, 1.0, rng, heterogeneous::par);
+    CHECK(heterogeneous::sample_rows(hv, 5000, rng).get<int>().size() == 1000 && everything.get<std::string>() == hv.get<std::string>());
+    CHECK(heterogeneous::bernoulli_sample(hv, 0.0, rng).get<int>().empty());
+    CHECK_THROWS(heterogeneous::bernoulli_sample(hv, 1.5, rng), std::invalid_argument);
+
+    // a reservoir fed row by row holds rows of either half of the source about equally often
+    std::vector<long> kept(1000, 0);
+    bool full = true, reservoir_aligned = true;
+    for (int r = 0; r < 2000; ++r)
+    {
+        table source;
+        auto reservoir = heterogeneous::make_reservoir(source, 20, r);
+        for (int i = 0; i < 1000; ++i)
+        {
+            push_row(source, i);
+            if (i % 97 == 0) reservoir.sync();
+        }
+        table& s = reservoir.sample();
+        full = full && heterogeneous::rows(s) == 20;
+        reservoir_aligned = reservoir_aligned && aligned(s);
+        for (int v : s.get<int>()) ++kept[v];
+    }
+    long first_half = 0;
+    for (int i = 0; i < 500; ++i) first_half += kept[i];
+    CHECK(full && reservoir_aligned);
+    CHECK(first_half > 20000 * 0.95 && first_half < 20000 * 1.05);
+
+    // fewer rows than its capacity, then a source that shrank: the reservoir is drawn again
+    table small;
+    auto reservoir = heterogeneous::make_reservoir(small, 10);
+    push_row(small, 1);
+    CHECK(heterogeneous::rows(reservoir.sample()) == 1);
+    small.get<int>().clear();
+    small.get<std::string>().clear();
+    small.get<bool>().clear();
+    CHECK(heterogeneous::rows(reservoir.sample()) == 0);
+
+    // rows removed in place and replaced by as many appended ones before the next look
+    for (int i = 0; i < 5; ++i) push_row(small, i);
+    CHECK(heterogeneous::rows(reservoir.sample()) == 5);
+    heterogeneous::erase_rows_if<int>(small, [](int) { return true; });
+    for (int i = 100; i < 106; ++i) push_row(small, i);
+    const std::vector<int>& drawn = reservoir.sample().get<int>();
+    CHECK(drawn.size() == 6 && *std::min_element(drawn.begin(), drawn.end()) == 100);
+
+    return examples::report("sample");
+}
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/scan.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    heterogeneous::vector<long, double> hv;
+    const size_t n = 100003;
+    for (size_t i = 0; i < n; ++i)
+    {
+        hv.get<long>().push_back(static_cast<long>(i % 7));
+        hv.get<double>().push_back(1.0);
+    }
+
+    std::vector<long> expected = hv.get<long>();
+    std::partial_sum(expected.begin(), expected.end(), expected.begin());
+
+    std::vector<long> inclusive;
+    heterogeneous::inclusive_scan(hv.get<long>(), inclusive, heterogeneous::par);
+    CHECK(inclusive == expected);
+
+    // exclusive: init first, then running sums of the elements before
+    std::vector<long> exclusive, exclusive_seq;
+    heterogeneous::exclusive_scan(hv.get<long>(), exclusive, 5L, heterogeneous::par);
+    heterogeneous::exclusive_scan(hv.get<long>(), exclusive_seq, 5L);
+    CHECK(exclusive == exclusive_seq);
+    CHECK(exclusive[0] == 5);
+    CHECK(exclusive[n - 1] == expected[n - 2] + 5);
+
+    // in place on a container of hv, which advances its generation
+    const size_t generation = hv.generation();
+    heterogeneous::scan<long>(hv, heterogeneous::par);
+    CHECK(hv.get<long>() == expected);
+    CHECK(hv.generation() != generation);
+
+    heterogeneous::exclusive_scan<double>(hv, 0.0);
+    CHECK(hv.get<double>()[10] == 10.0);
+
+    // any associative operation
+    heterogeneous::inclusive_scan<double>(hv, [](double x, double y) { return x > y ? x : y; });
+    CHECK(hv.get<double>()[n - 1] == static_cast<double>(n - 1));
+
+    std::vector<int> empty;
+    heterogeneous::inclusive_scan(std::vector<int>(), empty, heterogeneous::par);
+    CHECK(empty.empty());
+
+    return examples::report("scan");
+}
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/select.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    heterogeneous::vector<int, std::string> hv;
+    const std::vector<int>& keys = hv.get<int>();
+    std::mt19937 rng(3);
+    for (int i = 0; i < 200000; ++i)
+    {
+        const int k = static_cast<int>(rng() % 10000);
+        hv.get<int>().push_back(k);
+        hv.get<std::string>().push_back(std::to_string(k));
+    }
+
+    // reference: row ids stably sorted by descending key, so that ties go to the lower id
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t x, size_t y) { return keys[x] > keys[y]; });
+
+    bool ranked = true;
+    for (size_t k : { size_t(0), size_t(1), size_t(10), size_t(1000), size_t(199999), size_t(400000) })
+    {
+        std::vector<size_t> expected(order.begin(), order.begin() + std::min(k, order.size()));
+        ranked = ranked && heterogeneous::top_k<int>(hv, k) == expected && heterogeneous::top_k<int>(hv, k, heterogeneous::par) == expected
+            && heterogeneous::top_k<int>(hv, k, heterogeneous::seq, std::greater<int>()) == expected;
+    }
+    CHECK(ranked);
+
+    const std::vector<size_t> smallest = heterogeneous::top_k<int>(hv, 5, std::less<int>());
+    CHECK(keys[smallest[0]] == *std::min_element(keys.begin(), keys.end()));
+
+    const int fourth_largest = keys[order[3]];
+
+    // rows before nth rank no later, rows after it no earlier, and containers stay aligned
+    const size_t nth = keys.size() / 2;
+    heterogeneous::nth_element_by<int>(hv, nth, heterogeneous::par);
+    bool partitioned = true;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        partitioned = partitioned && hv.get<std::string>()[i] == std::to_string(keys[i]);
+        partitioned = partitioned && (i < nth ? keys[i] <= keys[nth] : keys[i] >= keys[nth]);
+    }
+    CHECK(partitioned);
+
+    heterogeneous::nth_element_by<int>(hv, 3, std::greater<int>());
+    CHECK(keys[3] == fourth_largest);
+
+    CHECK_THROWS(heterogeneous::nth_element_by<int>(hv, keys.size()), std::out_of_range);
+
+    return examples::report("select");
+}
@@ -0,0 +1,102 @@
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/sharded.hpp"
+
+#include "check.hpp"
+
+typedef heterogeneous::sharded_vector<4, std::string, int> keyed;
+
+long sum(heterogeneous::vector<std::string, int>& rows)
+{
+    long total = 0;
+    for (int x : rows.get<int>()) total += x;
+    return total;
+}
+
+int main()
+{
+    // threads appending rows one at a time, by key, and in batches
+    heterogeneous::sharded_vector<8, long, std::string, double> sv;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&sv, t]()
+        {
+            heterogeneous::vector<long, std::string, double> buffer;
+            for (long i = 0; i < 10000; ++i)
+            {
+                const long id = t * 100000 + i;
+                if (i % 3 == 0) sv.push_back(id, std::to_string(id), id * 0.5);
+                else if (i % 3 == 1) sv.push_back_by<long>(id, std::to_string(id), id * 0.5);
+                else
+                {
+                    buffer.push_back(id, std::to_string(id), id * 0.5);
+                    if (buffer.get<long>().size() == 100) sv.append(buffer);
+                }
+            }
+            sv.append(buffer);
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK(sv.rows() == 80000);
+
+    {
+        auto view = sv.lock_all();
+        std::set<long> ids;
+        for (auto it = view.begin<long>(); it != view.end<long>(); ++it) ids.insert(*it);
+        bool aligned = true;
+        for (size_t i = 0; i < view.rows(); ++i) aligned = aligned && view.get<std::string>(i) == std::to_string(view.get<long>(i));
+        CHECK(ids.size() == 80000 && aligned);
+
+        size_t elements = 0;
+        view.for_each([&elements](auto& c) { elements += c.size(); });
+        CHECK(elements == 3 * 80000);
+        CHECK(view.locate(view.rows() - 1).first < 8);
+        CHECK_THROWS(view.locate(view.rows()), std::out_of_range);
+    }
+
+    // one thread takes every shard in turn
+    heterogeneous::sharded_vector<4, int> turns;
+    std::vector<size_t> shards;
+    for (int i = 0; i < 8; ++i) shards.push_back(turns.push_back(i));
+    bool in_turn = true;
+    for (size_t i = 1; i < shards.size(); ++i) in_turn = in_turn && shards[i] == (shards[i - 1] + 1) % 4;
+    CHECK(in_turn);
+
+    // rows of equal keys share a shard, whether appended one by one or in a batch
+    keyed kv;
+    heterogeneous::vector<std::string, int> batch;
+    for (int i = 0; i < 1000; ++i) batch.push_back("k" + std::to_string(i % 37), i);
+    kv.append_by<std::string>(batch);
+    CHECK(batch.get<int>().empty() && kv.rows() == 1000);
+    CHECK(kv.push_back_by<std::string>("k5", 1000) == keyed::shard_of<std::string>("k5"));
+    CHECK(kv.push_back_by<int>("k5", 1001) == keyed::shard_of<int>(1001));
+
+    // the row keyed by its int instead is skipped
+    std::vector<int> together(4, 0);
+    kv.for_each_shard(heterogeneous::par, [&together](heterogeneous::vector<std::string, int>& rows, size_t s)
+    {
+        bool ok = true;
+        for (size_t i = 0; i < rows.get<int>().size(); ++i)
+            if (rows.get<int>()[i] != 1001) ok = ok && keyed::shard_of(rows.get<std::string>()[i]) == s;
+        together[s] = ok;
+    });
+    CHECK(together == std::vector<int>(4, 1));
+
+    const long expected = 999L * 1000 / 2 + 1000 + 1001;
+    CHECK(kv.transform_reduce_shards(0L, heterogeneous::par, std::plus<long>(), sum) == expected);
+    CHECK(kv.transform_reduce_shards(0L, std::plus<long>(), sum) == expected);
+
+    CHECK(kv.with_shard(1, [](heterogeneous::vector<std::string, int>& rows) { return rows.get<int>().size(); }) <= 1002);
+    CHECK_THROWS(kv.with_shard(9, [](heterogeneous::vector<std::string, int>&) { return 0; }), std::out_of_range);
+    kv.clear();
+    CHECK(kv.rows() == 0);
+
+    return examples::report("sharded");
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/sketch.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    heterogeneous::vector<long, double> hv;
+    std::vector<long>& keys = hv.get<long>();
+    std::vector<double>& values = hv.get<double>();
+
+    // sketches made before the containers fill up catch up on the elements appended since
+    auto distinct = heterogeneous::make_hyperloglog<long>(hv);
+    auto frequencies = heterogeneous::make_count_min<long>(hv, 0.0005, 0.01, 10);
+    auto distribution = heterogeneous::make_kll_sketch<double>(hv);
+
+    std::mt19937_64 rng(7);
+    std::exponential_distribution<double> exponential(1.0);
+    std::map<long, long> counts;
+    const long n = 300000;
+    for (long i = 0; i < n; ++i)
+    {
+        // every tenth key is one of 7 heavy hitters
+        const long k = i % 10 == 0 ? i % 7 : static_cast<long>(rng() % 100000);
+        keys.push_back(k);
+        values.push_back(exponential(rng));
+        ++counts[k];
+    }
+
+    const double exact = static_cast<double>(counts.size());
+    CHECK(std::abs(distinct.estimate() - exact) < 0.03 * exact);
+
+    // count-min never underestimates, and overestimates by at most epsilon of the total with high probability
+    CHECK(frequencies.total() == static_cast<std::uint64_t>(n));
+    CHECK(frequencies.estimate(0) >= static_cast<std::uint64_t>(counts[0]) && frequencies.estimate(0) <= counts[0] + 0.0005 * n);
+    const auto heavy = frequencies.heavy_hitters(0.01);
+    bool hitters = heavy.size() == 7;
+    for (const auto& h : heavy) hitters = hitters && h.first >= 0 && h.first < 7;
+    CHECK(hitters);
+
+    // the rank of each estimated quantile is close to the requested one
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    bool ranks = true;
+    for (double q : { 0.01, 0.25, 0.5, 0.9, 0.99 })
+    {
+        const double r = (std::upper_bound(sorted.begin(), sorted.end(), distribution.quantile(q)) - sorted.begin()) / static_cast<double>(n);
+        ranks = ranks && std::abs(r - q) < 0.01;
+    }
+    CHECK(ranks);
+    CHECK(distribution.quantile(1.0) == sorted.back());
+    CHECK(std::abs(distribution.rank(1.0) - (std::upper_bound(sorted.begin(), sorted.end(), 1.0) - sorted.begin()) / static_cast<double>(n)) < 0.01);
+
+    // merged sketches summarize both containers
+    heterogeneous::vector<long, double> other;
+    for (long i = 0; i < n / 2; ++i)
+    {
+        other.get<long>().push_back(1000000 + i);
+        other.get<double>().push_back(10 + exponential(rng));
+    }
+    auto other_distinct = heterogeneous::make_hyperloglog<long>(other);
+    auto other_frequencies = heterogeneous::make_count_min<long>(other, 0.0005, 0.01, 10);
+    auto other_distribution = heterogeneous::make_kll_sketch<double>(other);
+
+    auto all_distinct = distinct;
+    all_distinct.merge(other_distinct);
+    CHECK(std::abs(all_distinct.estimate() - (exact + n / 2)) < 0.03 * (exact + n / 2));
+    auto all_frequencies = frequencies;
+    all_frequencies.merge(other_frequencies);
+    CHECK(all_frequencies.total() == static_cast<std::uint64_t>(n + n / 2));
+    auto all_distribution = distribution;
+    all_distribution.merge(other_distribution);
+    CHECK(all_distribution.count() == static_cast<std::uint64_t>(n + n / 2) && all_distribution.quantile(0.8) > 10);
+
+    // shrinking a container rebuilds its sketches
+    keys.resize(10);
+    CHECK(frequencies.total() == 10 && std::abs(distinct.estimate() - 10) < 1);
+
+    // so does rewriting it in place once the generation advances, even at the same size
+    for (long& k : keys) k = 42;
+    hv.touch();
+    CHECK(frequencies.estimate(42) == 10 && std::abs(distinct.estimate() - 1) < 1);
+
+    values.clear();
+    CHECK_THROWS(distribution.quantile(0.5), std::out_of_range);
+
+    // refilling after clearing is caught the same way
+    for (int i = 0; i < 1000; ++i) values.push_back(i < 500 ? 1.0 : 2.0);
+    CHECK(distribution.quantile(0.5) == 1.0 && distribution.count() == 1000);
+    values.clear();
+    for (int i = 0; i < 2000; ++i) values.push_back(3.0);
+    hv.touch();
+    CHECK(distribution.quantile(0.5) == 3.0 && distribution.count() == 2000);
+
+    return examples::report("sketch");
+}
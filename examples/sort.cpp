@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/sort.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    std::mt19937_64 rng(1);
+    heterogeneous::vector<int, double, std::string, unsigned char, long long, float> hv;
+    const size_t n = 200000;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int v = static_cast<int>(rng());
+        hv.get<int>().push_back(v);
+        hv.get<double>().push_back(static_cast<double>(static_cast<std::int64_t>(rng())) / 1e10);
+        hv.get<std::string>().push_back(std::to_string(v));
+        hv.get<unsigned char>().push_back(static_cast<unsigned char>(rng()));
+        hv.get<long long>().push_back(static_cast<long long>(rng()));
+        hv.get<float>().push_back(static_cast<float>(static_cast<int>(rng() % 2000) - 1000) / 7.0f);
+    }
+
+    // radix and sample sorts agree with std::sort, negative values included
+    auto expected = hv.get<double>();
+    std::sort(expected.begin(), expected.end());
+    auto radix = hv.get<double>();
+    heterogeneous::radix_sort(radix);
+    CHECK(radix == expected);
+    auto sample = hv.get<double>();
+    heterogeneous::sample_sort(sample);
+    CHECK(sample == expected);
+
+    auto wide = hv.get<long long>(), wide_radix = wide;
+    std::sort(wide.begin(), wide.end());
+    heterogeneous::radix_sort(wide_radix);
+    CHECK(wide == wide_radix);
+
+    auto narrow = hv.get<unsigned char>(), narrow_radix = narrow;
+    std::sort(narrow.begin(), narrow.end());
+    heterogeneous::radix_sort(narrow_radix);
+    CHECK(narrow == narrow_radix);
+
+    // stable: equal floats keep their row order
+    const auto ids = heterogeneous::sort_indices<float>(hv);
+    CHECK(ids == heterogeneous::sort_indices<float>(hv, heterogeneous::par));
+    bool stable = true;
+    const auto& f = hv.get<float>();
+    for (size_t i = 1; i < n; ++i) stable = stable && (f[ids[i - 1]] < f[ids[i]] || (f[ids[i - 1]] == f[ids[i]] && ids[i - 1] < ids[i]));
+    CHECK(stable);
+
+    // sorting by one container reorders every container along
+    heterogeneous::sort_rows<int>(hv, heterogeneous::par);
+    CHECK(std::is_sorted(hv.get<int>().begin(), hv.get<int>().end()));
+    bool aligned = true;
+    for (size_t i = 0; i < n; ++i) aligned = aligned && hv.get<std::string>()[i] == std::to_string(hv.get<int>()[i]);
+    CHECK(aligned);
+
+    // NaNs and signed zeros: par orders them exactly as the sequential radix sort
+    heterogeneous::vector<double, int> special;
+    const double values[] = { 1.5, -0.0, 0.0, NAN, -NAN, -2.0, INFINITY };
+    for (size_t i = 0; i < n; ++i)
+    {
+        special.get<double>().push_back(values[rng() % 7]);
+        special.get<int>().push_back(static_cast<int>(i));
+    }
+    CHECK(heterogeneous::sort_indices<double>(special) == heterogeneous::sort_indices<double>(special, heterogeneous::par));
+
+    heterogeneous::vector<double, int> seq_rows, par_rows;
+    seq_rows = special;
+    par_rows = special;
+    heterogeneous::sort_rows<double>(seq_rows);
+    heterogeneous::sort_rows<double>(par_rows, heterogeneous::par);
+    CHECK(seq_rows.get<int>() == par_rows.get<int>());
+
+    auto keys = special.get<double>();
+    heterogeneous::radix_sort(keys);
+    heterogeneous::sort<double>(special, heterogeneous::par);
+    CHECK(std::memcmp(keys.data(), special.get<double>().data(), n * sizeof(double)) == 0);
+    CHECK(std::isnan(keys.front()) && std::signbit(keys.front()));
+    CHECK(std::isnan(keys.back()) && !std::signbit(keys.back()));
+    const auto is_zero = [](double v) { return v == 0.0; };
+    CHECK(std::signbit(*std::find_if(keys.begin(), keys.end(), is_zero)));
+    CHECK(!std::signbit(*std::find_if(keys.rbegin(), keys.rend(), is_zero)));
+
+    heterogeneous::sort<std::string>(hv, heterogeneous::par);
+    CHECK(std::is_sorted(hv.get<std::string>().begin(), hv.get<std::string>().end()));
+
+    return examples::report("sort");
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/statistics.hpp"
+
+#include "check.hpp"
+
+bool close(double x, double y, double tolerance) { return std::abs(x - y) <= tolerance * std::max(1.0, std::abs(y)); }
+
+int main()
+{
+    heterogeneous::vector<double, int> hv;
+    std::vector<double>& values = hv.get<double>();
+    std::vector<int>& counts = hv.get<int>();
+
+    auto value_stats = heterogeneous::make_running_stats<double>(hv);
+    auto count_stats = heterogeneous::make_running_stats<int>(hv);
+    CHECK_THROWS(value_stats.min(), std::out_of_range);
+    CHECK(value_stats.count() == 0 && value_stats.variance() == 0);
+
+    // a large offset with a small spread: naive sums of squares would lose the variance
+    std::mt19937 rng(1);
+    std::normal_distribution<double> normal(1e9, 2.0);
+    const int n = 300000;
+    for (int i = 0; i < n; ++i)
+    {
+        values.push_back(normal(rng));
+        counts.push_back(i % 100);
+    }
+
+    double sum = 0;
+    for (double v : values) sum += v - 1e9;
+    const double mean = 1e9 + sum / n;
+    double m2 = 0;
+    for (double v : values) m2 += (v - mean) * (v - mean);
+    const double lowest = *std::min_element(values.begin(), values.end()), highest = *std::max_element(values.begin(), values.end());
+
+    CHECK(value_stats.count() == static_cast<std::uint64_t>(n));
+    CHECK(close(value_stats.mean(), mean, 1e-12) && close(value_stats.variance(), m2 / n, 1e-6));
+    CHECK(value_stats.min() == lowest && value_stats.max() == highest);
+
+    // one pass, sequentially and by parallel blocks merged
+    const heterogeneous::statistics<double> s = heterogeneous::describe<double>(hv);
+    const heterogeneous::statistics<double> p = heterogeneous::describe<double>(hv, heterogeneous::par);
+    CHECK(close(s.mean, mean, 1e-12) && close(p.mean, mean, 1e-12));
+    CHECK(close(s.variance(), m2 / n, 1e-6) && close(p.variance(), m2 / n, 1e-6) && p.min == lowest && p.max == highest);
+
+    CHECK(close(count_stats.mean(), 49.5, 1e-12) && count_stats.max() == 99 && count_stats.min() == 0);
+    CHECK(close(count_stats.sample_variance(), 833.25 * n / (n - 1), 1e-9));
+
+    // shrinking the container recomputes its statistics
+    counts.resize(10);
+    CHECK(count_stats.count() == 10 && close(count_stats.mean(), 4.5, 1e-12));
+
+    // as does rewriting it in place, or shrinking and refilling it between queries, once the generation advances
+    for (int& c : counts) c *= 2;
+    hv.touch();
+    CHECK(count_stats.count() == 10 && close(count_stats.mean(), 9, 1e-12) && count_stats.max() == 18);
+    counts.clear();
+    counts.assign(20, 7);
+    hv.touch();
+    CHECK(count_stats.count() == 20 && count_stats.mean() == 7 && count_stats.variance() == 0);
+
+    // merging gives the statistics of both containers
+    heterogeneous::vector<double, int> other;
+    other.get<double>().assign(n, 1e9 + 10);
+    auto other_stats = heterogeneous::make_running_stats<double>(other);
+    value_stats.merge(other_stats);
+    const double both = (mean + 1e9 + 10) / 2;
+    CHECK(value_stats.count() == static_cast<std::uint64_t>(2 * n) && close(value_stats.mean(), both, 1e-12));
+    CHECK(close(value_stats.variance(), (m2 + n * (mean - both) * (mean - both) + n * (1e9 + 10 - both) * (1e9 + 10 - both)) / (2 * n), 1e-5));
+
+    return examples::report("statistics");
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/timeseries.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    // rows out of time order are sorted stably by timestamp when indexed
+    heterogeneous::vector<long, double, int> hv;
+    hv.push_back(5, 1.0, 1);
+    hv.push_back(3, 2.0, 2);
+    hv.push_back(9, 3.0, 3);
+    auto ts = heterogeneous::make_time_series(hv);
+    CHECK(ts.times() == std::vector<long>{ 3, 5, 9 } && hv.get<double>() == std::vector<double>{ 2, 1, 3 });
+
+    // late rows go after every row not later than them
+    CHECK(ts.append(7, 4.0, 4) == 2 && ts.append(12, 5.0, 5) == 4 && ts.append(-3, 6.0, 6) == 0 && ts.append(7, 7.0, 7) == 4);
+    CHECK(ts.times() == std::vector<long>{ -3, 3, 5, 7, 7, 9, 12 });
+    CHECK(hv.get<int>() == std::vector<int>{ 6, 2, 1, 4, 7, 3, 5 });
+
+    const auto w = ts.window(5, 10);
+    CHECK(w.first == 2 && w.last == 6 && w.size() == 4);
+    CHECK(ts.window(10, 5).size() == 0);
+
+    // windows start at multiples of the width, negative times included
+    const std::vector<std::pair<long, double> > tumbling = { { -5, 6.0 }, { 0, 2.0 }, { 5, 15.0 }, { 10, 5.0 } };
+    CHECK(ts.tumbling<double>(5) == tumbling);
+
+    // trailing windows (t - 4, t]
+    CHECK(ts.sliding_sum<double>(4) == std::vector<double>{ 6, 2, 3, 5, 12, 14, 8 });
+    CHECK(ts.sliding_min<int>(4) == std::vector<int>{ 6, 2, 1, 1, 1, 3, 3 });
+    CHECK(ts.sliding_max<double>(4) == std::vector<double>{ 6, 2, 2, 4, 7, 7, 5 });
+    CHECK(ts.sliding_mean<int>(4)[3] == 2.5);
+
+    // against brute force, over random floating point timestamps
+    heterogeneous::vector<double, double> random;
+    auto rts = heterogeneous::make_time_series(random);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0, 1000);
+    for (int i = 0; i < 3000; ++i) rts.append(uniform(rng), uniform(rng));
+
+    const std::vector<double>& time = random.get<double, 0>();
+    const std::vector<double>& values = random.get<double, 1>();
+    CHECK(std::is_sorted(time.begin(), time.end()));
+
+    const std::vector<double> maxima = rts.sliding_max<double, 1>(10.0), sums = rts.sliding_sum<double, 1>(10.0);
+    bool sliding = true;
+    for (size_t i = 0; i < time.size(); ++i)
+    {
+        double m = -1, s = 0;
+        for (size_t j = 0; j <= i; ++j)
+        {
+            if (time[i] - time[j] < 10.0)
+            {
+                m = std::max(m, values[j]);
+                s += values[j];
+            }
+        }
+        sliding = sliding && m == maxima[i] && std::abs(s - sums[i]) < 1e-6;
+    }
+    CHECK(sliding);
+
+    // infinite timestamps leave every window but their own
+    heterogeneous::vector<double, int> unbounded;
+    auto uts = heterogeneous::make_time_series(unbounded);
+    uts.append(-INFINITY, 8);
+    uts.append(-INFINITY, 16);
+    uts.append(1.0, 1);
+    uts.append(2.0, 2);
+    uts.append(INFINITY, 4);
+    CHECK(uts.sliding_sum<int>(5.0) == std::vector<int>{ 8, 16, 1, 3, 4 });
+    CHECK(uts.sliding_max<int>(5.0) == std::vector<int>{ 8, 16, 1, 2, 4 });
+    CHECK(uts.sliding_min<int>(5.0) == std::vector<int>{ 8, 16, 1, 1, 4 });
+    CHECK(uts.sliding_mean<int>(5.0) == std::vector<double>{ 8, 16, 1, 1.5, 4 });
+
+    // NaN timestamps are rejected, appended or already in the vector
+    CHECK_THROWS(uts.append(NAN, 0), std::invalid_argument);
+    CHECK(heterogeneous::rows(unbounded) == 5);
+    unbounded.push_back(NAN, 0);
+    CHECK_THROWS(heterogeneous::make_time_series(unbounded), std::invalid_argument);
+
+    // inserting a late row moves rows in place, which advances the generation
+    const size_t generation = hv.generation();
+    ts.append(13, 0.0, 0);
+    CHECK(hv.generation() == generation);
+    ts.append(0, 0.0, 0);
+    CHECK(hv.generation() != generation);
+
+    CHECK_THROWS(ts.sliding_sum<double>(0), std::invalid_argument);
+    CHECK_THROWS(ts.tumbling<double>(-1), std::invalid_argument);
+
+    return examples::report("timeseries");
+}
@@ -0,0 +1,48 @@
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/transform.hpp"
+
+#include "check.hpp"
+
+// results need not be default constructible
+struct count
+{
+    explicit count(size_t n) : n(n)
+    {};
+
+    size_t n;
+};
+
+int main()
+{
+    heterogeneous::vector<int, double, std::string, double> hv;
+    hv.push_back(1, 2.5, "abc", 4.0);
+    hv.get<double, 1>().push_back(5);
+
+    const auto sizes = heterogeneous::transform_lanes(hv, [](auto& c) { return c.size(); });
+    CHECK(sizes == std::make_tuple(size_t(1), size_t(1), size_t(1), size_t(2)));
+
+    // results of different types, one per container, each in its own task
+    const auto names = heterogeneous::transform_lanes(hv, heterogeneous::par, [](auto& c) { return std::to_string(c.size()) + "x"; });
+    CHECK(std::get<0>(names) == "1x" && std::get<3>(names) == "2x");
+    const auto counts = heterogeneous::transform_lanes(hv, heterogeneous::par, [](auto& c) { return count(c.size()); });
+    CHECK(std::get<3>(counts).n == 2);
+    const auto firsts = heterogeneous::transform_lanes(hv, [](auto& c) { return c.front(); });
+    CHECK(std::get<0>(firsts) == 1 && std::get<2>(firsts) == "abc" && std::get<3>(firsts) == 4.0);
+
+    CHECK(heterogeneous::transform_reduce_lanes(hv, size_t(0), std::plus<size_t>(), [](auto& c) { return c.size(); }) == 5);
+
+    // reduced in container order, even when transformed concurrently
+    const auto concatenate = [](std::string a, size_t b) { return a + std::to_string(b); };
+    CHECK(heterogeneous::transform_reduce_lanes(hv, std::string(), heterogeneous::par, concatenate, [](auto& c) { return c.size(); }) == "1112");
+    CHECK(heterogeneous::transform_reduce_lanes(hv, std::string(), heterogeneous::seq, concatenate, [](auto& c) { return c.size(); }) == "1112");
+
+    CHECK_THROWS(heterogeneous::transform_lanes(hv, heterogeneous::par, [](auto& c) -> int { if (c.size() == 2) throw std::runtime_error("two"); return 0; }), std::runtime_error);
+
+    return examples::report("transform");
+}
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/unique.hpp"
+
+#include "check.hpp"
+
+static void push_row(heterogeneous::vector<int, std::string, double>& hv, int i, const std::string& s, double d)
+{
+    hv.get<int>().push_back(i);
+    hv.get<std::string>().push_back(s);
+    hv.get<double>().push_back(d);
+}
+
+int main()
+{
+    heterogeneous::vector<int, std::string, double> hv;
+    push_row(hv, 1, "x", 0.0);
+    push_row(hv, 2, "y", 0.0);
+    push_row(hv, 1, "x", 0.0);
+    push_row(hv, 3, "z", 0.0);
+    push_row(hv, 2, "q", 0.0);
+    push_row(hv, 1, "x", 1.0);
+
+    // rows equal in every container: only the third repeats the first
+    auto all = hv;
+    CHECK(heterogeneous::unique_rows(all) == 1);
+    CHECK(all.get<int>() == std::vector<int>{ 1, 2, 3, 2, 1 });
+    CHECK(all.get<std::string>() == std::vector<std::string>{ "x", "y", "z", "q", "x" });
+    CHECK(all.get<double>() == std::vector<double>{ 0, 0, 0, 0, 1 });
+
+    // rows equal in the named containers; the first of each key is kept
+    auto some = hv;
+    CHECK(heterogeneous::unique_rows<heterogeneous::lane<int>, heterogeneous::lane<std::string> >(some, heterogeneous::par) == 2);
+    CHECK(some.get<std::string>() == std::vector<std::string>{ "x", "y", "z", "q" });
+
+    auto ints = hv;
+    CHECK(heterogeneous::unique<int>(ints) == 3);
+    CHECK(ints.get<int>() == std::vector<int>{ 1, 2, 3 } && ints.get<std::string>() == std::vector<std::string>{ "x", "y", "z" });
+
+    // hash partitioned deduplication keeps the same rows, in the same order
+    heterogeneous::vector<int, long> big;
+    std::mt19937 rng(1);
+    for (int i = 0; i < 300000; ++i)
+    {
+        big.get<int>().push_back(static_cast<int>(rng() % 1000));
+        big.get<long>().push_back(static_cast<long>(rng() % 50));
+    }
+    auto big_par = big;
+    const size_t removed = heterogeneous::unique_rows(big);
+    CHECK(removed == heterogeneous::unique_rows(big_par, heterogeneous::par));
+    CHECK(big.get<int>() == big_par.get<int>() && big.get<long>() == big_par.get<long>());
+    CHECK(heterogeneous::rows(big) <= 50000 && heterogeneous::unique_rows(big) == 0);
+
+    return examples::report("unique");
+}
@@ -0,0 +1,92 @@
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "heterogeneous.hpp"
+
+#include "check.hpp"
+
+typedef heterogeneous::vector<int, double, std::string, double> table;
+
+// a distinct element type per container, for a vector of many containers
+template<size_t I>
+struct column
+{
+    double value;
+
+    bool operator==(const column& rhs) const { return value == rhs.value; }
+};
+
+template<size_t... I>
+heterogeneous::vector<column<I>...> make_record(std::index_sequence<I...>);
+
+typedef decltype(make_record(std::make_index_sequence<200>())) record;
+
+template<size_t... I>
+void fill(record& hv, std::index_sequence<I...>)
+{
+    for (size_t row = 0; row < 3; ++row) hv.push_back(column<I>{ static_cast<double>(row + I) }...);
+    hv.insert_row(0, column<I>{ -1.0 }...);
+}
+
+int main()
+{
+    table a, b;
+    a.push_back(1, 2.0, "x", 3.0);
+    b = a;
+    CHECK(a == b && a.eq(b) && !(a != b) && a.lte(b) && !a.lt(b));
+
+    // containers of the same type are distinct
+    b.get<double, 1>().push_back(1.0);
+    CHECK(!(a == b) && !a.eq(b) && !(a < b) && !a.lt(b));
+    const table& constant = a;
+    CHECK(constant.get<double, 1>()[0] == 3.0 && constant.get<double>()[0] == 2.0);
+
+    CHECK_THROWS(a.get<char>(), std::invalid_argument);
+    CHECK_THROWS((a.get<double, 2>()), std::invalid_argument);
+
+    // all_of stops at the first container failing the test
+    int calls = 0;
+    CHECK(!a.all_of([&calls](const auto& c) { ++calls; return c.size() == 7; }) && calls == 1);
+    CHECK(a.any_of<std::string>([](const std::vector<std::string>& c) { return c[0] == "x"; }));
+
+    a.for_each<double>([](std::vector<double>& c) { c.push_back(9); });
+    CHECK(a.get<double>().size() == 2 && a.get<double, 1>().size() == 2 && a.get<int>().size() == 1);
+
+    struct counter
+    {
+        int n = 0;
+        void operator()(const std::vector<int>&) { ++n; }
+    };
+    CHECK(a.for_each<int>(counter()).n == 1);
+
+    a.insert_row(0, 5, 6.0, "y", 7.0);
+    CHECK(a.get<int>() == std::vector<int>{ 5, 1 } && a.get<std::string>()[0] == "y" && a.get<double, 1>()[0] == 7.0);
+
+    table moved(std::move(a));
+    CHECK(a.get<int>().empty() && moved.get<int>().size() == 2 && moved == moved);
+
+    heterogeneous::vector<int> one;
+    one.push_back(3);
+    CHECK(one.size() == 1 && one.get<int>()[0] == 3);
+
+    // hundreds of containers behave like a few
+    record wide;
+    fill(wide, std::make_index_sequence<200>());
+    record copy(wide);
+    CHECK(wide == copy && wide.size() == 200);
+    CHECK(wide.get<column<0> >()[0].value == -1.0 && wide.get<column<199> >()[3].value == 201.0);
+
+    size_t elements = 0;
+    wide.for_each([&elements](const auto& c) { elements += c.size(); });
+    CHECK(elements == 800);
+
+    copy.get<column<150> >()[1].value = 0.5;
+    CHECK(!(wide == copy));
+    wide.for_each(copy, [](auto& c, auto& x) { c.swap(x); });
+    CHECK(wide.get<column<150> >()[1].value == 0.5 && copy.get<column<150> >()[1].value == 150.0);
+
+    return examples::report("vector");
+}
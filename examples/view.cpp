@@ -0,0 +1,49 @@
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/view.hpp"
+
+#include "check.hpp"
+
+namespace view = heterogeneous::view;
+
+int main()
+{
+    heterogeneous::vector<int, double, double> hv;
+    for (int i = 0; i < 100; ++i)
+    {
+        hv.get<int>().push_back(i);
+        hv.get<double, 0>().push_back(i * 0.5);
+        hv.get<double, 1>().push_back(2.0);
+    }
+
+    // first five even numbers times 10: 0 + 20 + 40 + 60 + 80
+    auto v = hv.get<int>() | view::filter([](int x) { return x % 2 == 0; }) | view::transform([](int x) { return x * 10; }) | view::take(5);
+    CHECK(std::accumulate(v.begin(), v.end(), 0) == 200);
+
+    // fused and lazy: take stops pulling elements through filter once satisfied
+    size_t calls = 0;
+    auto first = view::lane<int>(hv) | view::filter([&calls](int x) { ++calls; return x < 3; }) | view::take(3);
+    int sum = 0;
+    for (int x : first) sum += x;
+    CHECK(sum == 3);
+    CHECK(calls == 3);
+
+    // zip pairs elements, by reference
+    auto products = view::zip(hv.get<double, 0>(), hv.get<double, 1>()) | view::transform([](std::tuple<const double&, const double&> t) { return std::get<0>(t) * std::get<1>(t); });
+    CHECK(std::accumulate(products.begin(), products.end(), 0.0) == 4950.0);
+
+    for (auto t : view::zip(hv.get<double, 0>(), hv.get<double, 1>())) std::get<1>(t) = 3.0;
+    CHECK(hv.get<double, 1>()[5] == 3.0);
+
+    // zip stops at the shorter sequence
+    auto shorter = view::zip(hv.get<int>() | view::take(3), hv.get<double>());
+    CHECK(std::distance(shorter.begin(), shorter.end()) == 3);
+
+    CHECK((hv.get<double>() | view::filter([](double d) { return d < 0; })).empty());
+
+    return examples::report("view");
+}
@@ -0,0 +1,55 @@
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <typeindex>
+#include <utility>
+
+#include "heterogeneous.hpp"
+
+#include "check.hpp"
+
+template<size_t I>
+struct column
+{
+    double value;
+};
+
+template<size_t... I>
+heterogeneous::vector<column<I>...> make_record(std::index_sequence<I...>);
+
+typedef decltype(make_record(std::make_index_sequence<200>())) record;
+
+int main()
+{
+    heterogeneous::vector<int, double, std::string, double> hv;
+    hv.push_back(1, 2.5, "abc", 4.0);
+    hv.get<double, 1>().push_back(5);
+
+    // containers picked by a position known only at run time
+    size_t sizes = 0;
+    for (size_t i = 0; i < 4; ++i) sizes = sizes * 10 + hv.visit_lane(i, [](const auto& c) { return c.size(); });
+    CHECK(sizes == 1112);
+    CHECK_THROWS(hv.visit_lane(4, [](auto&) {}), std::out_of_range);
+
+    const auto& constant = hv;
+    CHECK(constant.visit_lane(2, [](const auto& c) { return c.size(); }) == 1);
+    heterogeneous::visit_lane(hv, 0, [](auto& c) { c.push_back({}); });
+    CHECK(hv.get<int>().size() == 2);
+
+    // by type, the first container of that type
+    CHECK(hv.visit_lane_by_type(typeid(double), [](auto& c) { return c.size(); }) == 1);
+    CHECK(heterogeneous::visit_lane_by_type(hv, typeid(std::string), [](auto& c) { return c.size(); }) == 1);
+    CHECK_THROWS(hv.visit_lane_by_type(typeid(char), [](auto&) {}), std::invalid_argument);
+
+    record wide;
+    wide.get<column<137> >().resize(3);
+    CHECK(wide.visit_lane_by_type(typeid(column<137>), [](auto& c) { return c.size(); }) == 3);
+    CHECK(wide.visit_lane(137, [](auto& c) { return c.size(); }) == 3);
+    CHECK(wide.visit_lane_by_type(typeid(column<136>), [](auto& c) { return c.size(); }) == 0);
+
+    size_t total = 0;
+    for (size_t i = 0; i < 200 * 5; ++i) total += wide.visit_lane(i % 200, [](auto& c) { return c.size(); });
+    CHECK(total == 15);
+
+    return examples::report("visit");
+}
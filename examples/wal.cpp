@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/wal.hpp"
+
+#include "check.hpp"
+
+typedef heterogeneous::logged_vector<long, std::string, double, bool> logged;
+typedef logged::vector_type table;
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& path, const std::string& contents)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+bool exists(const std::string& path)
+{
+    return std::ifstream(path).good();
+}
+
+void remove_files(const std::string& base)
+{
+    std::remove((base + ".wal").c_str());
+    std::remove((base + ".snap").c_str());
+}
+
+// the files as they are on disk, as a crash would leave them
+void copy_files(const std::string& from, const std::string& to)
+{
+    remove_files(to);
+    if (exists(from + ".wal")) write_file(to + ".wal", read_file(from + ".wal"));
+    if (exists(from + ".snap")) write_file(to + ".snap", read_file(from + ".snap"));
+}
+
+table contents(logged& v)
+{
+    return v.read([](const table& data) { return data; });
+}
+
+int main()
+{
+    const char* tmp = std::getenv("TMPDIR");
+    const std::string base = std::string(tmp ? tmp : "/tmp") + "/heterogeneous_wal_example";
+    const std::string image = base + "_image";
+    remove_files(base);
+
+    table committed;
+    logged::lsn_type committed_lsn = 0;
+    {
+        logged v(base);
+        CHECK(v.last_lsn() == 0 && v.log_bytes() == 0);
+
+        // concurrent committers share flushes; each returns once its own changes are durable
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&v, t]()
+            {
+                for (int i = 0; i < 200; ++i)
+                {
+                    v.push_back(t * 1000 + i, std::string(i % 7, 'x'), i * 0.5, i % 2 == 0);
+                    if (i % 10 == 0) v.commit();
+                }
+                v.commit();
+            });
+        }
+        for (auto& t : threads) t.join();
+        CHECK(v.last_lsn() == 800 && v.durable_lsn() == 800);
+
+        table batch;
+        for (int i = 0; i < 50; ++i) batch.push_back(-i, "batch", 1.0, true);
+        v.append(batch);
+        v.assign<std::string>(0, "changed");
+        v.assign<double>(1, 100.0);
+        v.assign<bool>(2, true);
+        v.truncate(820);
+        CHECK_THROWS(v.assign<long>(5000, 1), std::out_of_range);
+        v.commit();
+        committed = contents(v);
+        committed_lsn = v.last_lsn();
+        CHECK(heterogeneous::rows(committed) == 820 && v.durable_lsn() == v.last_lsn());
+
+        // a crash now loses the change not yet committed, and only it
+        v.push_back(7, "uncommitted", 7.0, false);
+        copy_files(base, image);
+    }
+
+    {
+        logged crashed(image);
+        CHECK(contents(crashed) == committed && crashed.last_lsn() == committed_lsn);
+    }
+    {
+        // closing committed it
+        logged reopened(base);
+        table recovered = contents(reopened);
+        CHECK(heterogeneous::rows(recovered) == 821 && recovered.get<std::string>().back() == "uncommitted");
+    }
+
+    // a record torn by a crash ends the log: it is discarded and the log cut back to the record before
+    const size_t intact = read_file(image + ".wal").size();
+    {
+        logged v(image);
+        v.push_back(8, "torn", 8.0, true);
+        v.commit();
+    }
+    const std::string log = read_file(image + ".wal");
+    CHECK(log.size() > intact);
+    write_file(image + ".wal", log.substr(0, log.size() - 3));
+    {
+        logged v(image);
+        CHECK(contents(v) == committed && v.last_lsn() == committed_lsn);
+    }
+    CHECK(read_file(image + ".wal").size() == intact);
+
+    // so is garbage after the last record
+    write_file(image + ".wal", read_file(image + ".wal") + "garbage after the log");
+    {
+        logged v(image);
+        CHECK(contents(v) == committed);
+    }
+    CHECK(read_file(image + ".wal").size() == intact);
+
+    // a snapshot empties the log; later records replay onto it
+    {
+        logged v(base);
+        v.checkpoint();
+        CHECK(v.log_bytes() == 0 && exists(base + ".snap"));
+        v.assign<long>(0, -100);
+        v.push_back(9, "after snapshot", 9.0, false);
+        v.commit();
+        CHECK(v.log_bytes() > 0);
+    }
+    {
+        logged v(base);
+        table recovered = contents(v);
+        CHECK(heterogeneous::rows(recovered) == 822 && recovered.get<long>()[0] == -100 && recovered.get<std::string>().back() == "after snapshot");
+    }
+
+    // commit() checkpoints by itself once the log grows past checkpoint_bytes
+    {
+        logged v(base, 1024);
+        for (int i = 0; i < 100; ++i) v.push_back(i, "automatic", 0.0, true);
+        v.commit();
+        CHECK(v.log_bytes() == 0);
+    }
+    {
+        logged v(base);
+        table recovered = contents(v);
+        CHECK(heterogeneous::rows(recovered) == 922 && recovered.get<std::string>().back() == "automatic");
+    }
+
+    // files written for other containers are refused, snapshot and log alike
+    CHECK_THROWS((heterogeneous::logged_vector<int, std::string>(base)), std::invalid_argument);
+    CHECK_THROWS((heterogeneous::logged_vector<int, std::string>(image)), std::invalid_argument);
+
+    remove_files(base);
+    remove_files(image);
+
+    return examples::report("wal");
+}
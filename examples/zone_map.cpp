@@ -0,0 +1,49 @@
+#include <cmath>
+#include <iostream>
+
+#include "heterogeneous.hpp"
+#include "heterogeneous/zone_map.hpp"
+
+#include "check.hpp"
+
+int main()
+{
+    heterogeneous::vector<int, double> hv;
+    for (int i = 0; i < 10000; ++i) hv.get<int>().push_back(i);
+
+    auto zm = heterogeneous::make_zone_map<int>(hv, 100);
+    CHECK(zm.blocks() == 100);
+    CHECK(zm.count(150, 349) == 200);
+    CHECK(zm.stats().blocks_skipped > 90); // only blocks 1 to 3 overlap [150, 349]
+
+    // appends are picked up on the next query
+    hv.get<int>().push_back(5);
+    CHECK(zm.count(5, 5) == 2);
+    CHECK(zm.blocks() == 101);
+    CHECK(zm.sum(0, 9, 0L) == 50);
+
+    // NaN never matches a range
+    hv.get<double>().push_back(1.0);
+    hv.get<double>().push_back(NAN);
+    hv.get<double>().push_back(2.0);
+    auto zd = heterogeneous::make_zone_map<double>(hv, 4);
+    size_t matches = 0;
+    zd.filter(0.0, 5.0, [&matches](size_t, double) { ++matches; });
+    CHECK(matches == 2);
+
+    hv.get<int>().clear();
+    CHECK(zm.blocks() == 0);
+
+    // clearing and refilling between queries is only seen through the generation
+    for (int i = 0; i < 60; ++i) hv.get<int>().push_back(i);
+    CHECK(zm.count(0, 59) == 60);
+    hv.get<int>().clear();
+    for (int i = 0; i < 70; ++i) hv.get<int>().push_back(100 + i);
+    hv.touch();
+    CHECK(zm.count(0, 59) == 0);
+    CHECK(zm.count(100, 169) == 70);
+
+    CHECK_THROWS(heterogeneous::make_zone_map<int>(hv, 0), std::invalid_argument);
+
+    return examples::report("zone_map");
+}
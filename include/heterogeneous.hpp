@@ -40,9 +40,320 @@ namespace boost
 }
 
 
+#include <cstdint>
 #include <vector>
+#include <type_traits>
+#include <utility>
 namespace heterogeneous
 {
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        // Everything below is computed by expanding parameter packs over an
+        // index_sequence rather than by recursing over Types..., so that the
+        // number of instantiations and their nesting depth stay linear in the
+        // number of containers.
+
+        typedef int expand[];
+
+        template<typename U>
+        struct type_identity
+        {
+            typedef U type;
+        };
+
+        /*!
+        * \brief Container of type U at position I of a vector.
+        */
+        template<size_t I, typename U>
+        struct lane_storage
+        {
+            std::vector<U> container;
+        };
+
+        /*!
+        * \brief Holds every container of a vector as a direct base, one per position.
+        */
+        template<typename Indices, typename... Types>
+        struct lane_set;
+
+        template<size_t... I, typename... Types>
+        struct lane_set<std::index_sequence<I...>, Types...> : lane_storage<I, Types>...
+        {};
+
+        // the base of a lane_set with position I is unique: U is deduced without recursion
+        template<size_t I, typename U>
+        std::vector<U>& lane_at(lane_storage<I, U>& s)
+        {
+            return s.container;
+        }
+
+        template<size_t I, typename U>
+        const std::vector<U>& lane_at(const lane_storage<I, U>& s)
+        {
+            return s.container;
+        }
+
+        template<size_t I, typename U>
+        type_identity<U> lane_type(const lane_storage<I, U>&);
+
+        /*!
+        * \brief Element of type U at position I of a row being added to a vector.
+        */
+        template<size_t I, typename U>
+        struct row_value
+        {
+            const U& value;
+        };
+
+        template<typename Indices, typename... Types>
+        struct row;
+
+        template<size_t... I, typename... Types>
+        struct row<std::index_sequence<I...>, Types...> : row_value<I, Types>...
+        {
+            explicit row(const Types&... values) : row_value<I, Types>{ values }...
+            {};
+        };
+
+        template<size_t I, typename U>
+        const U& row_at(const row_value<I, U>& r)
+        {
+            return r.value;
+        }
+
+        template<typename U, typename... Types>
+        constexpr size_t count_of_v()
+        {
+            const bool same[] = { false, std::is_same<U, Types>::value... };
+
+            size_t result = 0;
+            for (bool s : same) result += s ? 1 : 0;
+            return result;
+        }
+
+        // returns sizeof...(Types) if there is no Nth container of type U
+        template<typename U, size_t N, typename... Types>
+        constexpr size_t index_of_v()
+        {
+            const bool same[] = { false, std::is_same<U, Types>::value... };
+
+            size_t seen = 0;
+            for (size_t i = 1; i <= sizeof...(Types); ++i)
+            {
+                if (same[i] && seen++ == N) return i - 1;
+            }
+            return sizeof...(Types);
+        }
+
+        template<typename U, typename... Types>
+        struct count_of : std::integral_constant<size_t, count_of_v<U, Types...>()>
+        {};
+
+        template<size_t N, typename... Types>
+        struct type_at
+        {
+            static_assert(N < sizeof...(Types), "heterogeneous::vector has no container with this index.");
+
+            typedef typename decltype(lane_type<N>(std::declval<const lane_set<std::index_sequence_for<Types...>, Types...>&>()))::type type;
+        };
+
+        template<typename U, size_t N, typename... Types>
+        struct index_of : std::integral_constant<size_t, index_of_v<U, N, Types...>()>
+        {
+            static_assert(index_of_v<U, N, Types...>() < sizeof...(Types), "heterogeneous::vector has no container with this type and index.");
+        };
+
+        /*!
+        * \brief Compile time properties of the containers of a heterogeneous::vector<Types...>.
+        */
+        template<typename... Types>
+        struct type_pack
+        {
+            /*!
+            * \brief Number of containers.
+            */
+            static constexpr size_t size_v = sizeof...(Types);
+
+            /*!
+            * \brief Number of containers of type U.
+            */
+            template<typename U>
+            static constexpr size_t multiplicity_v = count_of<U, Types...>::value;
+
+            /*!
+            * \brief Position among all containers of the Nth container of type U.
+            */
+            template<typename U, size_t N = 0>
+            static constexpr size_t index_of_v = index_of<U, N, Types...>::value;
+
+            /*!
+            * \brief Element type of the container at position N.
+            */
+            template<size_t N>
+            using type_at_t = typename type_at<N, Types...>::type;
+        };
+
+        template<typename... Types>
+        constexpr size_t type_pack<Types...>::size_v;
+
+        template<typename... Types>
+        template<typename U>
+        constexpr size_t type_pack<Types...>::multiplicity_v;
+
+        template<typename... Types>
+        template<typename U, size_t N>
+        constexpr size_t type_pack<Types...>::index_of_v;
+
+        // selects every container when given any_type, else the containers of that type
+        struct any_type
+        {};
+
+        template<typename U, typename V>
+        struct selects : std::is_same<U, V>
+        {};
+
+        template<typename V>
+        struct selects<any_type, V> : std::true_type
+        {};
+
+        template<typename Function, typename V>
+        void apply_lane(Function& fn, std::vector<V>& c, std::true_type)
+        {
+            fn(c);
+        }
+
+        template<typename Function, typename V>
+        void apply_lane(Function&, std::vector<V>&, std::false_type)
+        {}
+
+        template<typename U, typename Function, typename V>
+        void apply_lane(Function& fn, std::vector<V>& c)
+        {
+            apply_lane(fn, c, selects<U, V>());
+        }
+
+        template<typename Function, typename V>
+        bool test_lane(Function& fn, std::vector<V>& c, bool stop, std::true_type)
+        {
+            return static_cast<bool>(fn(c)) == stop;
+        }
+
+        template<typename Function, typename V>
+        bool test_lane(Function&, std::vector<V>&, bool, std::false_type)
+        {
+            return false;
+        }
+
+        template<typename U, typename Function, typename V>
+        bool test_lane(Function& fn, std::vector<V>& c, bool stop)
+        {
+            return test_lane(fn, c, stop, selects<U, V>());
+        }
+
+        /*!
+        * \brief Perfect hash from the distinct element types of a vector to the position of their first container.
+        *
+        * Built once per vector type: a multiplier is searched for which maps
+        * every type to its own slot of a table at least twice as large as
+        * the number of types, so that a lookup hashes once, reads one slot
+        * and compares one std::type_index.
+        */
+        class type_table
+        {
+        public:
+            // an enumerator, never odr-used, so that this class in a header needs no out-of-class definition
+            enum : size_t { npos = static_cast<size_t>(-1) };
+
+            explicit type_table(const std::vector<std::type_index>& types) : multiplier_(0), shift_(63)
+            {
+                // distinct types, each with the position of its first container
+                std::vector<std::type_index> keys;
+                std::vector<size_t> positions;
+                for (size_t i = 0; i < types.size(); ++i)
+                {
+                    size_t k = 0;
+                    while (k < keys.size() && keys[k] != types[i]) ++k;
+                    if (k < keys.size()) continue;
+
+                    keys.push_back(types[i]);
+                    positions.push_back(i);
+                }
+
+                std::uint64_t seed = 0;
+                for (size_t bits = 1; ; ++bits)
+                {
+                    if ((size_t(1) << bits) < 2 * keys.size()) continue;
+
+                    for (int attempt = 0; attempt < 64; ++attempt)
+                    {
+                        multiplier_ = next_multiplier(seed);
+                        shift_ = static_cast<unsigned>(64 - bits);
+                        if (place(keys, positions, size_t(1) << bits)) return;
+                    }
+                }
+            };
+
+            /*!
+            * \brief Returns the position of the first container of the given type, npos if there is none.
+            */
+            size_t find(std::type_index type) const
+            {
+                const size_t s = slot(type);
+                return keys_[s] == type ? positions_[s] : npos;
+            }
+
+        private:
+            std::vector<std::type_index> keys_;
+            std::vector<size_t> positions_;
+            std::uint64_t multiplier_;
+            unsigned shift_;
+
+            size_t slot(std::type_index type) const
+            {
+                return static_cast<size_t>((static_cast<std::uint64_t>(type.hash_code()) * multiplier_) >> shift_);
+            }
+
+            bool place(const std::vector<std::type_index>& keys, const std::vector<size_t>& positions, size_t slots)
+            {
+                // empty slots hold a type no vector can contain
+                keys_.assign(slots, std::type_index(typeid(type_table)));
+                positions_.assign(slots, npos);
+
+                for (size_t k = 0; k < keys.size(); ++k)
+                {
+                    const size_t s = slot(keys[k]);
+                    if (positions_[s] != npos) return false;
+
+                    keys_[s] = keys[k];
+                    positions_[s] = positions[k];
+                }
+                return true;
+            }
+
+            static std::uint64_t next_multiplier(std::uint64_t& seed)
+            {
+                // splitmix64, forced odd
+                std::uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                return (z ^ (z >> 31)) | 1;
+            }
+        };
+
+        template<typename... Types>
+        const type_table& type_table_of()
+        {
+            static const type_table table(std::vector<std::type_index>{ std::type_index(typeid(Types))... });
+            return table;
+        }
+    }
+    /*!
+    * \endcond
+    */
+
     /*!
     * \cond Skip Doxygen documentation of this forward declaration.
     */
@@ -51,12 +362,17 @@ namespace heterogeneous
     * \endcond
     */
 
+    /*!
+    * \brief Heterogeneous container holding one std::vector per template argument, in order.
+    *
+    * The containers are direct members laid out side by side, and every
+    * operation over them is a single pack expansion: both compile time and
+    * the generated code grow linearly with the number of containers, which
+    * may reach the hundreds.
+    */
     template<typename T, typename... Types>
-    class vector<T, Types...>
+    class vector<T, Types...> : public detail::type_pack<T, Types...>
     {
-        // Friends
-        template<typename... Args> friend class vector;
-
     public:
         // Typedefs
         typedef T value_type;
@@ -65,81 +381,183 @@ namespace heterogeneous
         using container_type = std::vector<U>;
 
     private:
-        void* container_;
-        vector<Types...> next_;
-        size_t* counter_;
+        typedef std::index_sequence_for<T, Types...> indices;
+
+        detail::lane_set<indices, T, Types...> lanes_;
+        size_t generation_;
 
         // Helper Functions
-        vector<Types...>& next()
+        template<size_t I>
+        auto& container()
         {
-            return next_;
+            return detail::lane_at<I>(lanes_);
         }
 
-        const vector<Types...>& next() const
+        template<size_t I>
+        const auto& container() const
         {
-            return next_;
+            return detail::lane_at<I>(lanes_);
         }
 
-        void setcounter(size_t*& pntr)
+        template<typename Compare, size_t... I>
+        bool compare(const vector<value_type, Types...>& rhs, Compare cmp, std::index_sequence<I...>) const
         {
-            counter_ = pntr;
-            next().setcounter(pntr);
+            bool result = true;
+            (void)detail::expand{ 0, (result = result && cmp(container<I>(), rhs.template container<I>()), 0)... };
+            return result;
         }
 
-    public:
-        // Constructors & Destructors
-        vector() : container_(new container_type<value_type>), next_(nullptr), counter_(nullptr)
+        // calls fn on each container selected by U until fn returns stop; returns whether it did
+        template<typename U, typename Function, size_t... I>
+        bool find_lane(Function& fn, bool stop, std::index_sequence<I...>)
         {
-            //counter_ is deallocated in vector<T> specializetion destructor
-            counter_ = new size_t;
-            *counter_ = 0;
+            bool found = false;
+            (void)detail::expand{ 0, (found = found || detail::test_lane<U>(fn, container<I>(), stop), 0)... };
+            return found;
+        }
 
-            next().setcounter(counter_);
-        };
+        template<typename U, typename Function, size_t... I>
+        void apply_lanes(Function& fn, std::index_sequence<I...>)
+        {
+            (void)detail::expand{ 0, (detail::apply_lane<U>(fn, container<I>()), 0)... };
+        }
 
-        ~vector()
-		{
-			if (container_ != nullptr) delete static_cast< container_type<value_type>* >(container_);
-		};
+        template<typename Function, size_t... I>
+        void apply_pairs(vector<value_type, Types...>& x, Function& fn, std::index_sequence<I...>)
+        {
+            (void)detail::expand{ 0, (fn(container<I>(), x.template container<I>()), 0)... };
+        }
 
-    private:
-        vector(size_t* pntr) : container_(new container_type<value_type>), next_(pntr), counter_(pntr)
-        { /*this constructor does not allocate memory for counter_*/ };
+        template<size_t... I>
+        void swap_lanes(vector<value_type, Types...>& x, std::index_sequence<I...>)
+        {
+            (void)detail::expand{ 0, (container<I>().swap(x.template container<I>()), 0)... };
+        }
+
+        template<typename Row, size_t... I>
+        void push_row(const Row& row, std::index_sequence<I...>)
+        {
+            (void)detail::expand{ 0, (container<I>().push_back(detail::row_at<I>(row)), 0)... };
+        }
+
+        template<typename Row, size_t... I>
+        void insert_row(size_t pos, const Row& row, std::index_sequence<I...>)
+        {
+            (void)detail::expand{ 0, (container<I>().insert(container<I>().begin() + pos, detail::row_at<I>(row)), 0)... };
+        }
+
+        template <size_t N>
+        std::type_index type_of(std::true_type) const
+        {
+            return std::type_index(typeid(typename detail::type_pack<T, Types...>::template type_at_t<N>));
+        }
+
+        template <size_t N>
+        std::type_index type_of(std::false_type) const
+        {
+            throw std::out_of_range(std::string("Element N=") + std::to_string(N) + std::string(" does not exist in object."));
+        }
+
+        template<size_t I, typename Result, typename Self, typename Function>
+        static Result visit_at(Self& self, Function& fn)
+        {
+            static_assert(std::is_same<decltype(fn(self.template container<I>())), Result>::value,
+                "heterogeneous::vector::visit_lane requires fn to return the same type for every container.");
+            return fn(self.template container<I>());
+        }
+
+        // one entry per position: dispatching is a bounds check and an indirect call
+        template<typename Result, typename Self, typename Function, size_t... I>
+        static Result visit(Self& self, size_t index, Function& fn, std::index_sequence<I...>)
+        {
+            typedef Result(*visitor)(Self&, Function&);
+            static const visitor table[] = { &vector::template visit_at<I, Result, Self, Function>... };
+
+            if (index >= sizeof...(I))
+                throw std::out_of_range(std::string("Element N=") + std::to_string(index) + std::string(" does not exist in object."));
+
+            return table[index](self, fn);
+        }
+
+        static size_t position(std::type_index type)
+        {
+            const size_t index = detail::type_table_of<T, Types...>().find(type);
+            if (index == detail::type_table::npos)
+                throw std::invalid_argument(std::string("Type ") + std::string(type.name()) + std::string(" does not exist in object."));
+
+            return index;
+        }
+
+        template <typename U, size_t N>
+        container_type<U>& find(std::true_type)
+        {
+            return container<detail::type_pack<T, Types...>::template index_of_v<U, N> >();
+        }
+
+        template <typename U, size_t N>
+        const container_type<U>& find(std::true_type) const
+        {
+            return container<detail::type_pack<T, Types...>::template index_of_v<U, N> >();
+        }
+
+        template <typename U, size_t N>
+        container_type<U>& find(std::false_type) const
+        {
+            throw std::invalid_argument(std::string("Type ") + std::string(typeid(U).name()) + std::string(" with index N=") + std::to_string(N) + std::string(" does not exist in object."));
+        }
 
     public:
+        // Constructors & Destructors
+        vector() : generation_(0)
+        {};
+
+        /*!
+        * \brief Constructs vector holding copies of the containers of x.
+        */
+        vector(const vector<value_type, Types...>& x) : lanes_(x.lanes_), generation_(0)
+        {};
+
+        /*!
+        * \brief Constructs vector taking over the containers of x, leaving x with empty ones.
+        */
+        vector(vector<value_type, Types...>&& x) : vector()
+        {
+            swap(x);
+        };
+
         // Operators
         /*!
         * \brief Assigns contents of rhs to vector.
         */
         vector<value_type, Types...>& operator=(const vector<value_type, Types...>& rhs)
         {
-            setEQUALTO(rhs);
+            lanes_ = rhs.lanes_;
+            touch();
             return *this;
         }
 
-    private:
-        void setEQUALTO(const vector<value_type, Types...>& x)
+        /*!
+        * \brief Exchanges contents of rhs and vector.
+        */
+        vector<value_type, Types...>& operator=(vector<value_type, Types...>&& rhs)
         {
-            if (container_ != nullptr) delete static_cast< container_type<value_type>* >(container_);
-            container_ = new container_type<value_type>(*static_cast< container_type<value_type>* >(x.container_));
-            next().setEQUALTO(x.next());
+            swap(rhs);
+            return *this;
         }
 
-    public:
         // Relational Operators & Methods
         /*!
         * \brief Returns true if == operator evaluates to true for each element in object.
         */
-        bool operator==(const vector<value_type, Types...>& rhs)
+        bool operator==(const vector<value_type, Types...>& rhs) const
         {
-            if (!(*static_cast< container_type<value_type>* >(container_) == rhs.get<value_type, 0>())) return false;
-            return next().operator==(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return a == b; }, indices());
         }
 
         /*!
         * \brief Returns true if == operator evaluates to false for any element in object.
         */
-        bool operator!=(const vector<value_type, Types...>& rhs)
+        bool operator!=(const vector<value_type, Types...>& rhs) const
         {
             return !operator==(rhs);
         }
@@ -147,57 +565,48 @@ namespace heterogeneous
         /*!
         * \brief Returns true if < operator evaluates to true for each element in object.
         */
-        bool operator<(const vector<value_type, Types...>& rhs)
+        bool operator<(const vector<value_type, Types...>& rhs) const
         {
-            if (!(*static_cast< container_type<value_type>* >(container_) < rhs.get<value_type, 0>())) return false;
-            return next().operator<(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return a < b; }, indices());
         }
 
         /*!
         * \brief Returns true if > operator evaluates to true for each element in object.
         */
-        bool operator>(const vector<value_type, Types...>& rhs)
+        bool operator>(const vector<value_type, Types...>& rhs) const
         {
-            if (!(*static_cast< container_type<value_type>* >(container_) > rhs.get<value_type, 0>())) return false;
-            return next().operator>(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return a > b; }, indices());
         }
 
         /*!
         * \brief Returns true if <= operator evaluates to true for each element in object.
         */
-        bool operator<=(const vector<value_type, Types...>& rhs)
+        bool operator<=(const vector<value_type, Types...>& rhs) const
         {
-            if (!(*static_cast< container_type<value_type>* >(container_) <= rhs.get<value_type, 0>())) return false;
-            return next().operator<=(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return a <= b; }, indices());
         }
 
         /*!
         * \brief Returns true if >= operator evaluates to true for each element in object.
         */
-        bool operator>= (const vector<value_type, Types...>& rhs)
+        bool operator>= (const vector<value_type, Types...>& rhs) const
         {
-            if (!(*static_cast< container_type<value_type>* >(container_) >= rhs.get<value_type, 0>())) return false;
-            return next().operator>=(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return a >= b; }, indices());
         }
 
         /*!
         * \brief Same as operator==() but strictly enforces container element size matching.
         */
-        bool eq(const vector<value_type, Types...>& rhs)
+        bool eq(const vector<value_type, Types...>& rhs) const
         {
             // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-
-            // Although this code is duplicated in operator==, we cannot call operator== here as a replacement.
-            // The above test for matching number of elements must be checked recursively
-            if (!(*static_cast< container_type<value_type>* >(container_) == rhs.get<value_type, 0>())) return false;
-            return next().eq(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return a.size() == b.size() && a == b; }, indices());
         }
 
         /*!
         * \brief Same as operator!=() but strictly enforces container element size matching.
         */
-        bool ne(const vector<value_type, Types...>& rhs)
+        bool ne(const vector<value_type, Types...>& rhs) const
         {
             return !eq(rhs);
         }
@@ -205,141 +614,98 @@ namespace heterogeneous
         /*!
         * \brief Same as operator<() but strictly enforces container element size matching.
         */
-        bool lt(const vector<value_type, Types...>& rhs)
+        bool lt(const vector<value_type, Types...>& rhs) const
         {
             // if zero elements, cannot be less than
-            if (static_cast<container_type<value_type>*>(container_)->size() == 0) return false;
-
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-            if (!(*static_cast< container_type<value_type>* >(container_) < rhs.get<value_type, 0>())) return false;
-            return next().lt(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return !a.empty() && a.size() == b.size() && a < b; }, indices());
         }
 
         /*!
         * \brief Same as operator>() but strictly enforces container element size matching.
         */
-        bool gt(const vector<value_type, Types...>& rhs)
+        bool gt(const vector<value_type, Types...>& rhs) const
         {
             // if zero elements, cannot be greater than
-            if (static_cast<container_type<value_type>*>(container_)->size() == 0) return false;
-
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-
-            if (!(*static_cast< container_type<value_type>* >(container_) > rhs.get<value_type, 0>())) return false;
-            return next().gt(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return !a.empty() && a.size() == b.size() && a > b; }, indices());
         }
 
         /*!
         * \brief Same as operator<=() but strictly enforces container element size matching.
         */
-        bool lte(const vector<value_type, Types...>& rhs)
+        bool lte(const vector<value_type, Types...>& rhs) const
         {
             // if zero elements, cannot be less than, but can be equal!
-			// Therefore, don't need to check size.
-
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-
-            if (!(*static_cast< container_type<value_type>* >(container_) <= rhs.get<value_type, 0>())) return false;
-            return next().lte(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return a.size() == b.size() && a <= b; }, indices());
         }
 
         /*!
         * \brief Same as operator>=() but strictly enforces container element size matching.
         */
-        bool gte(const vector<value_type, Types...>& rhs)
+        bool gte(const vector<value_type, Types...>& rhs) const
         {
             // if zero elements, cannot be greater than, but can be equal!
-			// Therefore, don't need to check size.
-
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-
-            if (!(*static_cast< container_type<value_type>* >(container_) >= rhs.get<value_type, 0>())) return false;
-            return next().gte(rhs.next());
+            return compare(rhs, [](const auto& a, const auto& b) { return a.size() == b.size() && a >= b; }, indices());
         }
 
         // Methods
         /*!
-        * \brief Returns the total number of elements in vector.
+        * \brief Returns the number of containers in vector.
         */
-        size_t size()
+        static constexpr size_t size()
         {
-            size_t result = 1;
-            next().size(result);
-
-            return result;
+            return sizeof...(Types) + 1;
         }
 
-    private:
-        void size(size_t& val)
+        /*!
+        * \brief Returns the number of times rows have been rewritten or removed in place.
+        *
+        * Appending elements leaves the generation unchanged, so summaries of a
+        * container only need a full rebuild when it differs from the value
+        * they were built at.
+        */
+        const size_t& generation() const
         {
-            next().size(++val);
+            return generation_;
         }
 
-    public:
-		/*!
-		* \brief Returns std::type_index of items within the Nth container in object.
-		*/
-		template <size_t N = 0>
-		std::type_index type()
-		{
-			if (*counter_ == N)
-			{
-				*counter_ = 0;
-				return std::type_index(typeid(value_type));
-			}
-
-			++(*counter_);
-
-			return next().template type<N>();
-		}
-
         /*!
-        * \brief Returns the number of containers with type U.
+        * \brief Advances generation(). Call after modifying elements in place.
         */
-        template <typename U>
-        size_t multiplicity()
+        void touch()
         {
-            size_t result = 0;
-            next().template multiplicity<U>(result);
-
-            if (typeid(U) == typeid(value_type))
-                ++result;
+            ++generation_;
+        }
 
-            return result;
+        /*!
+        * \brief Returns std::type_index of items within the Nth container in object.
+        *
+        * If there is no Nth container, throws std::out_of_range exception.
+        */
+        template <size_t N = 0>
+        std::type_index type() const
+        {
+            return type_of<N>(std::integral_constant<bool, (N < sizeof...(Types) + 1)>());
         }
 
-    private:
+        /*!
+        * \brief Returns the number of containers with type U.
+        */
         template <typename U>
-        void multiplicity(size_t& val)
+        static constexpr size_t multiplicity()
         {
-            next().template multiplicity<U>(val);
-
-            if (typeid(U) == typeid(value_type))
-                ++val;
+            return detail::count_of<U, T, Types...>::value;
         }
 
-    public:
         /*!
         * \brief Returns reference to the Nth container of type U.
+        *
+        * The container is found at compile time. If there is no such
+        * container, throws std::invalid_argument exception.
         */
         template <typename U, size_t N = 0>
         container_type<U>& get()
         {
-            if (typeid(U) == typeid(value_type))
-            {
-                if (*counter_ == N)
-                {
-                    *counter_ = 0;
-                    return *static_cast< container_type<U>* >(container_);
-                }
-                ++(*counter_);
-            }
-
-            return next().template get<U, N>();
+            return find<U, N>(std::integral_constant<bool, (N < multiplicity<U>())>());
         }
 
         /*!
@@ -348,396 +714,138 @@ namespace heterogeneous
         template <typename U, size_t N = 0>
         const container_type<U>& get() const
         {
-            if (typeid(U) == typeid(value_type))
-            {
-                if (*counter_ == N)
-                {
-                    *counter_ = 0;
-                    return &static_cast< const container_type<U>* >(container_);
-                }
-                ++(*counter_);
-            }
-
-            return next().template get<U, N>();
+            return find<U, N>(std::integral_constant<bool, (N < multiplicity<U>())>());
         }
-		
+
 		// Algorithms
 		template<typename Function>
 		bool all_of(Function fn)
 		{
-			if ( !fn(*static_cast< container_type<value_type>* >(container_)) ) return false;
-			
-			return next().all_of(fn);
+			return !find_lane<detail::any_type>(fn, false, indices());
 		}
 
 		template<typename U, class Function>
 		bool all_of(Function fn)
 		{
-			if (typeid(U) != typeid(value_type))
-				return next().template all_of<U>(fn);
-
-			if ( !fn(*static_cast< container_type<U>* >(container_)) ) return false;
-
-			return next().template all_of<U>(fn);
+			return !find_lane<U>(fn, false, indices());
 		}
 
 		template<typename Function>
 		bool any_of(Function fn)
 		{
-			if ( fn(*static_cast< container_type<value_type>* >(container_)) ) return true;
-
-			return next().any_of(fn);
+			return find_lane<detail::any_type>(fn, true, indices());
 		}
 
 		template<typename U, class Function>
 		bool any_of(Function fn)
 		{
-			if (typeid(U) != typeid(value_type))
-				return next().template any_of<U>(fn);
-
-			if ( fn(*static_cast< container_type<U>* >(container_)) ) return true;
-
-			return next().template any_of<U>(fn);
+			return find_lane<U>(fn, true, indices());
 		}
 
 		template<typename Function>
 		bool none_of(Function fn)
 		{
-			if ( fn(*static_cast< container_type<value_type>* >(container_)) ) return false;
-
-			return next().none_of(fn);
+			return !find_lane<detail::any_type>(fn, true, indices());
 		}
 
 		template<typename U, typename Function>
 		bool none_of(Function fn)
 		{
-			if (typeid(U) != typeid(value_type))
-				return next().template none_of<U>(fn);
-
-			if ( fn(*static_cast< container_type<U>* >(container_)) ) return false;
-
-			return next().template none_of<U>(fn);
+			return !find_lane<U>(fn, true, indices());
 		}
 
 		template<typename Function>
 		Function for_each(Function fn)
-        {
-            fn( *static_cast< container_type<value_type>* >(container_) );
-            return next().for_each(fn);
-        }
+		{
+			apply_lanes<detail::any_type>(fn, indices());
+			return fn;
+		}
 
 		template<typename U, typename Function>
 		Function for_each(Function fn)
 		{
-			if(typeid(U) == typeid(value_type))
-			  fn(*static_cast< container_type<U>* >(container_));
-
-			return next().template for_each<U>(fn);
+			apply_lanes<U>(fn, indices());
+			return fn;
 		}
 
 		/*!
-		* \brief Swaps contents of object with x.
+		* \brief Calls fn(container, x_container) for each pair of corresponding containers of object and x.
 		*/
-		void swap(vector<value_type, Types...>& x)
-		{
-			void* temp = container_;
-			container_ = x.container_;
-			x.container_ = temp;
-
-			next().swap(x.next());
-		}
-    };
-
-    /*!
-    * \cond Skip Doxygen documentation of this specialization.
-    */
-    template<typename T>
-    class vector<T>
-    {
-        // Friends
-        template<typename... Args> friend class vector;
-
-    public:
-        // Typedefs
-        typedef T value_type;
-
-        template<typename U>
-        using container_type = std::vector<U>;
-
-    private:
-        void* container_;
-        size_t* counter_;
-
-        void setcounter(size_t*& pntr)
-        {
-            counter_ = pntr;
-        }
-
-    public:
-        vector() : container_(new container_type<value_type>), counter_(nullptr)
-        {
-            counter_ = new size_t;
-            *counter_ = 0;
-        };
-
-        ~vector()
-        {
-			if (container_ != nullptr) delete static_cast< container_type<value_type>* >(container_);
-            if (counter_ != nullptr) delete counter_;
-        };
-
-    private:
-        vector(size_t* pntr) : container_(new container_type<value_type>), counter_(pntr)
-        { /*this constructor does not allocate memory for counter_*/ };
-
-	public:
-        // Operators
-        vector<value_type>& operator=(const vector<value_type>& x)
-        {
-            setEQUALTO(x);
-            return *this;
-        }
-
-    private:
-        void setEQUALTO(const vector<value_type>& x)
-        {
-            if (container_ != nullptr) delete static_cast< container_type<value_type>* >(container_);
-            container_ = new container_type<value_type>(*static_cast< container_type<value_type>* >(x.container_));
-        }
-
-    public:
-        // Relational Operators & Methods
-        bool operator==(const vector<value_type>& rhs)
-        {
-            return *static_cast< container_type<value_type>* >(container_) == rhs.get<value_type, 0>();
-        }
-
-        bool operator!=(const vector<value_type>& rhs)
-        {
-            return !operator==(rhs);
-        }
-
-        bool operator<(const vector<value_type>& rhs)
-        {
-            return *static_cast< container_type<value_type>* >(container_) < rhs.get<value_type, 0>();
-        }
-
-        bool operator>(const vector<value_type>& rhs)
-        {
-            return *static_cast< container_type<value_type>* >(container_) > rhs.get<value_type, 0>();
-        }
-
-        bool operator<=(const vector<value_type>& rhs)
-        {
-            return *static_cast< container_type<value_type>* >(container_) <= rhs.get<value_type, 0>();
-        }
-
-        bool operator>= (const vector<value_type>& rhs)
-        {
-            return *static_cast< container_type<value_type>* >(container_) >= rhs.get<value_type, 0>();
-        }
-
-        bool eq(const vector<value_type>& rhs)
-        {
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-            return *static_cast< container_type<value_type>* >(container_) == rhs.get<value_type, 0>();
-        }
-
-        bool ne(const vector<value_type>& rhs)
-        {
-            return !eq(rhs);
-        }
-
-        bool lt(const vector<value_type>& rhs)
-        {
-            // if zero elements, cannot be less than
-            if (static_cast<container_type<value_type>*>(container_)->size() == 0) return false;
-
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-            return *static_cast< container_type<value_type>* >(container_) < rhs.get<value_type, 0>();
-        }
-
-        bool gt(const vector<value_type>& rhs)
-        {
-            // if zero elements, cannot be greater than
-            if (static_cast<container_type<value_type>*>(container_)->size() == 0) return false;
-
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-            return *static_cast< container_type<value_type>* >(container_) > rhs.get<value_type, 0>();
-        }
-
-        bool lte(const vector<value_type>& rhs)
-        {
-            // if zero elements, cannot be less than, but can be equal!
-			// Therefore, don't need to check size.
-
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-            return *static_cast< container_type<value_type>* >(container_) <= rhs.get<value_type, 0>();
-        }
-
-        bool gte(const vector<value_type>& rhs)
-        {
-            // if zero elements, cannot be greater than, but can be equal!
-			// Therefore, don't need to check size.
-
-            // number of elements must match
-            if (static_cast<container_type<value_type>*>(container_)->size() != rhs.get<value_type, 0>().size()) return false;
-            return *static_cast< container_type<value_type>* >(container_) >= rhs.get<value_type, 0>();
-        }
-
-        size_t size() { return 1; }
-
-    private:
-        void size(size_t& val) { ++val; }
-
-    public:
-		template <size_t N = 0>
-		std::type_index type()
-		{
-			if (*counter_ == N)
-			{
-				*counter_ = 0;
-				return std::type_index(typeid(value_type));
-			}
-			*counter_ = 0;
-
-			throw std::out_of_range(std::string("Element N=") + std::to_string(N) + std::string(" does not exist in object."));
-		}
-
-        template <typename U>
-        size_t multiplicity()
-        {
-            return (typeid(U) == typeid(value_type)) ? 1 : 0;
-        }
-
-    private:
-        template <typename U>
-        void multiplicity(size_t& val)
-        {
-            if (typeid(U) == typeid(value_type)) ++val;
-        }
-
-    public:
-        template <typename U, size_t N = 0>
-        container_type<U>& get()
-        {
-            if (typeid(U) == typeid(value_type))
-            {
-                if (*counter_ == N)
-                {
-                    *counter_ = 0;
-                    return *static_cast< container_type<U>* >(container_);
-                }
-            }
-            *counter_ = 0;
-
-            throw std::invalid_argument(std::string("Type ") + std::string(typeid(U).name()) + std::string(" with index N=") + std::to_string(N) + std::string(" does not exist in object."));
-        }
-
-        template <typename U, size_t N = 0>
-        const container_type<U>& get() const
-        {
-            if (typeid(U) == typeid(value_type))
-            {
-                if (*counter_ == N)
-                {
-                    *counter_ = 0;
-                    return *static_cast< const container_type<U>* >(container_);
-                }
-            }
-            *counter_ = 0;
-
-            throw std::invalid_argument(std::string("Type ") + std::string(typeid(U).name()) + std::string(" with index N=") + std::to_string(N) + std::string(" does not exist in object."));
-        }
-
-		// Algorithms
 		template<typename Function>
-		bool all_of(Function fn)
+		Function for_each(vector<value_type, Types...>& x, Function fn)
 		{
-			if (!fn(*static_cast< container_type<value_type>* >(container_))) return false;
-
-			return true;
+			apply_pairs(x, fn, indices());
+			return fn;
 		}
 
-		template<typename U, class Function>
-		bool all_of(Function fn)
+		/*!
+		* \brief Swaps contents of object with x.
+		*/
+		void swap(vector<value_type, Types...>& x)
 		{
-			if (typeid(U) != typeid(value_type))
-				return true;
-
-			if (!fn(*static_cast< container_type<U>* >(container_))) return false;
-
-			return true;
+			swap_lanes(x, indices());
+			touch();
+			x.touch();
 		}
 
-		template<typename Function>
-		bool any_of(Function fn)
+		/*!
+		* \brief Appends a row: value to the first container, rest to the following ones in order.
+		*/
+		void push_back(const value_type& value, const Types&... rest)
 		{
-			if (fn(*static_cast< container_type<value_type>* >(container_))) return true;
-
-			return false;
+			push_row(detail::row<indices, T, Types...>(value, rest...), indices());
 		}
 
-		template<typename U, class Function>
-		bool any_of(Function fn)
+		/*!
+		* \brief Inserts a row before row pos: value into the first container, rest into the following ones in order.
+		*
+		* Every container must hold at least pos elements. Advances generation()
+		* unless the row is inserted at the end.
+		*/
+		void insert_row(size_t pos, const value_type& value, const Types&... rest)
 		{
-			if (typeid(U) != typeid(value_type))
-				return false;
-
-			if ( fn(*static_cast< container_type<U>* >(container_)) ) return true;
-
-			return false;
+			if (pos != container<0>().size()) touch();
+			insert_row(pos, detail::row<indices, T, Types...>(value, rest...), indices());
 		}
 
+		/*!
+		* \brief Calls fn on the container at position index, chosen at runtime, and returns its result.
+		*
+		* Dispatches through a table of one function per position in O(1).
+		* fn must return the same type for every container. If there is no
+		* container at index, throws std::out_of_range exception.
+		*/
 		template<typename Function>
-		bool none_of(Function fn)
+		decltype(auto) visit_lane(size_t index, Function fn)
 		{
-			if (fn(*static_cast< container_type<value_type>* >(container_))) return false;
-
-			return true;
+			return visit<decltype(fn(container<0>()))>(*this, index, fn, indices());
 		}
 
-		template<typename U, typename Function>
-		bool none_of(Function fn)
+		template<typename Function>
+		decltype(auto) visit_lane(size_t index, Function fn) const
 		{
-			if (typeid(U) != typeid(value_type))
-				return true;
-
-			if (fn(*static_cast< container_type<U>* >(container_))) return false;
-
-			return true;
+			return visit<decltype(fn(container<0>()))>(*this, index, fn, indices());
 		}
 
+		/*!
+		* \brief Calls fn on the first container whose elements have the given type and returns its result.
+		*
+		* The position is found by a perfect hash of the element types, built
+		* once per vector type. If there is no such container, throws
+		* std::invalid_argument exception.
+		*/
 		template<typename Function>
-        Function for_each(Function fn )
-        {
-            fn( *static_cast< container_type<value_type>* >(container_) );
-			return fn;
-        }
-
-		template<typename U, typename Function>
-		Function for_each(Function fn)
+		decltype(auto) visit_lane_by_type(std::type_index type, Function fn)
 		{
-			if( typeid(U) == typeid(value_type) )
-			  fn(*static_cast< container_type<U>* >(container_));
-
-			return fn;
+			return visit_lane(position(type), fn);
 		}
 
-		void swap(vector<T>& x)
+		template<typename Function>
+		decltype(auto) visit_lane_by_type(std::type_index type, Function fn) const
 		{
-			void* temp = container_;
-			container_ = x.container_;
-			x.container_ = temp;
+			return visit_lane(position(type), fn);
 		}
     };
-    /*!
-    * \endcond
-    */
 
     template<typename... Args_lhs, typename... Args_rhs>
     bool operator==(const vector<Args_lhs...>& lhs, const vector<Args_rhs...>& rhs)
@@ -823,6 +931,24 @@ namespace heterogeneous
 		return hv.template for_each<U>(fn);
 	}
 
+	template<typename T, typename... Types, class Function>
+	Function for_each(vector<T, Types...>& hv, vector<T, Types...>& x, Function fn)
+	{
+		return hv.for_each(x, fn);
+	}
+
+	template<typename T, typename... Types, class Function>
+	decltype(auto) visit_lane(vector<T, Types...>& hv, size_t index, Function fn)
+	{
+		return hv.visit_lane(index, fn);
+	}
+
+	template<typename T, typename... Types, class Function>
+	decltype(auto) visit_lane_by_type(vector<T, Types...>& hv, std::type_index type, Function fn)
+	{
+		return hv.visit_lane_by_type(type, fn);
+	}
+
 
 
 
@@ -0,0 +1,771 @@
+#ifndef HETEROGENEOUS_ASYNC
+#define HETEROGENEOUS_ASYNC
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file async.hpp
+*
+* Asynchronous algorithms over a heterogeneous::vector. They submit their
+* work to an executor and return at once with a future, whose result
+* can be waited for or passed on to a continuation with then(), so that
+* stages of processing follow each other without blocking a thread.
+*
+* An executor is any object with a member execute(std::function<void()>)
+* running the function, now or later, on some thread. thread_pool and
+* inline_executor are provided.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+#include "transform.hpp"
+
+namespace heterogeneous
+{
+    template<typename T> class future;
+    template<typename T> class promise;
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        template<typename T>
+        struct future_value
+        {
+            std::unique_ptr<T> value;
+
+            void set(T v) { value.reset(new T(std::move(v))); }
+            T take() { return std::move(*value); }
+        };
+
+        template<>
+        struct future_value<void>
+        {
+            void set() {}
+            void take() {}
+        };
+
+        /*!
+        * \brief Result shared by a promise and its future, with the continuations waiting for it.
+        */
+        template<typename T>
+        class shared_state
+        {
+        public:
+            shared_state() : ready_(false)
+            {};
+
+            template<typename... Value>
+            void set_value(Value&&... v)
+            {
+                complete([&]() { result_.set(std::forward<Value>(v)...); });
+            }
+
+            void set_error(std::exception_ptr e)
+            {
+                complete([&]() { error_ = e; });
+            }
+
+            /*!
+            * \brief Sets a std::future_error with broken_promise as the result, unless a result is already set.
+            */
+            void abandon()
+            {
+                try_complete([&]() { error_ = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)); });
+            }
+
+            bool is_ready() const
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return ready_;
+            }
+
+            void wait() const
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_cv_.wait(lock, [this]() { return ready_; });
+            }
+
+            T take()
+            {
+                wait();
+                if (error_) std::rethrow_exception(error_);
+                return result_.take();
+            }
+
+            std::exception_ptr error() const
+            {
+                return error_;
+            }
+
+            /*!
+            * \brief Calls fn once the result is set: at once if it already is, else on the thread setting it.
+            */
+            void on_ready(std::function<void()> fn)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!ready_)
+                    {
+                        continuations_.push_back(std::move(fn));
+                        return;
+                    }
+                }
+                fn();
+            }
+
+        private:
+            mutable std::mutex mutex_;
+            mutable std::condition_variable ready_cv_;
+            bool ready_;
+            future_value<T> result_;
+            std::exception_ptr error_;
+            std::vector<std::function<void()> > continuations_;
+
+            template<typename Store>
+            void complete(Store store)
+            {
+                if (!try_complete(store)) throw std::logic_error("std::logic_error: promise already satisfied.");
+            }
+
+            // stores the result and runs the continuations, unless a result is already set
+            template<typename Store>
+            bool try_complete(Store store)
+            {
+                std::vector<std::function<void()> > pending;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (ready_) return false;
+
+                    store();
+                    ready_ = true;
+                    pending.swap(continuations_);
+                }
+                ready_cv_.notify_all();
+
+                for (auto& fn : pending) fn();
+                return true;
+            }
+        };
+
+        /*!
+        * \brief State of a promise, shared by its copies; abandons the result once the last copy is destroyed.
+        */
+        template<typename T>
+        struct promise_owner
+        {
+            std::shared_ptr<shared_state<T> > state;
+
+            promise_owner() : state(std::make_shared<shared_state<T> >())
+            {};
+
+            ~promise_owner()
+            {
+                state->abandon();
+            };
+        };
+
+        // sets the result of state to fn(args...), or to the exception it throws
+        template<typename R, typename Function, typename... Args>
+        void fulfil(shared_state<R>& state, std::false_type /*void*/, Function& fn, Args&&... args)
+        {
+            try
+            {
+                R r = fn(std::forward<Args>(args)...);
+                state.set_value(std::move(r));
+            }
+            catch (...)
+            {
+                state.set_error(std::current_exception());
+            }
+        }
+
+        template<typename Function, typename... Args>
+        void fulfil(shared_state<void>& state, std::true_type, Function& fn, Args&&... args)
+        {
+            try
+            {
+                fn(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                state.set_error(std::current_exception());
+                return;
+            }
+            state.set_value();
+        }
+
+        template<typename R, typename Function, typename... Args>
+        void fulfil(shared_state<R>& state, Function& fn, Args&&... args)
+        {
+            fulfil(state, std::is_void<R>(), fn, std::forward<Args>(args)...);
+        }
+
+        // calls fn with the value of an antecedent, or with nothing if it has none
+        template<typename T, typename Function>
+        struct continuation_result
+        {
+            typedef decltype(std::declval<Function&>()(std::declval<T>())) type;
+        };
+
+        template<typename Function>
+        struct continuation_result<void, Function>
+        {
+            typedef decltype(std::declval<Function&>()()) type;
+        };
+
+        template<typename R, typename T, typename Function>
+        void continue_with(shared_state<R>& next, shared_state<T>& antecedent, Function& fn)
+        {
+            T value = antecedent.take();
+            fulfil(next, fn, std::move(value));
+        }
+
+        template<typename R, typename Function>
+        void continue_with(shared_state<R>& next, shared_state<void>& antecedent, Function& fn)
+        {
+            antecedent.take();
+            fulfil(next, fn);
+        }
+
+        // sets the result of p to fn(), or to the exception it throws
+        template<typename R, typename Function>
+        void fulfil_promise(promise<R>& p, Function& fn)
+        {
+            std::unique_ptr<R> r;
+            try
+            {
+                r.reset(new R(fn()));
+            }
+            catch (...)
+            {
+                p.set_exception(std::current_exception());
+                return;
+            }
+            p.set_value(std::move(*r));
+        }
+
+        /*!
+        * \brief Counts down the tasks of one asynchronous algorithm and completes its promise after the last.
+        */
+        class join_counter
+        {
+        public:
+            explicit join_counter(size_t tasks) : remaining_(tasks)
+            {};
+
+            // keeps the first exception thrown by any task
+            void fail(std::exception_ptr e)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = e;
+            }
+
+            // returns true for the last task to finish
+            bool arrive()
+            {
+                return remaining_.fetch_sub(1) == 1;
+            }
+
+            std::exception_ptr error()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return error_;
+            }
+
+        private:
+            std::atomic<size_t> remaining_;
+            std::mutex mutex_;
+            std::exception_ptr error_;
+        };
+
+        template<typename T, typename... Types, typename Executor, typename Result, typename BinaryOp, typename UnaryOp, size_t... I>
+        void async_transform_reduce(vector<T, Types...>& hv, Executor& ex, promise<Result> p, Result init, BinaryOp reduce_op, UnaryOp transform_op, std::index_sequence<I...>)
+        {
+            typedef vector<T, Types...> vector_type;
+
+            // everything the tasks share; each constructs its own element of the results
+            struct job
+            {
+                std::tuple<std::unique_ptr<lane_result_t<I, UnaryOp, vector_type> >...> results;
+                vector_type* hv;
+                promise<Result> p;
+                Result init;
+                BinaryOp reduce_op;
+                UnaryOp transform_op;
+                join_counter join;
+
+                job(vector_type* hv, promise<Result> p, Result init, BinaryOp reduce_op, UnaryOp transform_op)
+                    : hv(hv), p(std::move(p)), init(std::move(init)), reduce_op(std::move(reduce_op)), transform_op(std::move(transform_op)), join(sizeof...(I))
+                {};
+
+                void finish()
+                {
+                    if (std::exception_ptr error = join.error())
+                    {
+                        p.set_exception(error);
+                        return;
+                    }
+
+                    auto combine = [this]()
+                    {
+                        (void)expand{ 0, (init = reduce_op(std::move(init), std::move(*std::get<I>(results))), 0)... };
+                        return std::move(init);
+                    };
+                    fulfil_promise(p, combine);
+                }
+            };
+
+            auto j = std::make_shared<job>(&hv, std::move(p), std::move(init), std::move(reduce_op), std::move(transform_op));
+
+            (void)expand{ 0, (ex.execute([j]()
+            {
+                try
+                {
+                    std::get<I>(j->results).reset(new lane_result_t<I, UnaryOp, vector_type>(j->transform_op(container_at<I>(*j->hv))));
+                }
+                catch (...)
+                {
+                    j->join.fail(std::current_exception());
+                }
+                if (j->join.arrive()) j->finish();
+            }), 0)... };
+        }
+
+        // runs fn(container) for each container of hv as tasks of ex, then done() after the last
+        template<typename T, typename... Types, typename Executor, typename Function, typename Done>
+        void async_lanes(vector<T, Types...>& hv, Executor& ex, std::shared_ptr<Function> fn, Done done)
+        {
+            auto join = std::make_shared<join_counter>(hv.size());
+            auto finish = std::make_shared<Done>(std::move(done));
+
+            hv.for_each([&ex, &fn, &join, &finish](auto& C)
+            {
+                auto* c = &C;
+                auto f = fn;
+                auto j = join;
+                auto d = finish;
+                ex.execute([c, f, j, d]()
+                {
+                    try
+                    {
+                        (*f)(*c);
+                    }
+                    catch (...)
+                    {
+                        j->fail(std::current_exception());
+                    }
+                    if (j->arrive()) (*d)(j->error());
+                });
+            });
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief Executor running each function at once on the calling thread.
+    */
+    struct inline_executor
+    {
+        void execute(std::function<void()> fn)
+        {
+            fn();
+        }
+    };
+
+    /*!
+    * \brief Executor running functions on a fixed set of threads, in submission order.
+    *
+    * Destroying the pool runs the functions still queued, then joins its
+    * threads.
+    */
+    class thread_pool
+    {
+    public:
+        // Constructors & Destructors
+        explicit thread_pool(size_t threads = detail::concurrency()) : stop_(false)
+        {
+            if (threads == 0) threads = 1;
+
+            workers_.reserve(threads);
+            for (size_t i = 0; i < threads; ++i) workers_.emplace_back([this]() { work(); });
+        };
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+
+            for (auto& t : workers_) t.join();
+        };
+
+        // Methods
+        /*!
+        * \brief Queues fn to run on one of the threads.
+        */
+        void execute(std::function<void()> fn)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(std::move(fn));
+            }
+            wake_.notify_one();
+        }
+
+        /*!
+        * \brief Returns the number of threads.
+        */
+        size_t size() const
+        {
+            return workers_.size();
+        }
+
+    private:
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()> > tasks_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stop_;
+
+        void work()
+        {
+            for (;;)
+            {
+                std::function<void()> fn;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                    if (tasks_.empty()) return;
+
+                    fn = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+
+                // a throwing task must not take the thread down; asynchronous algorithms report through their futures
+                try { fn(); } catch (...) {}
+            }
+        }
+    };
+
+    /*!
+    * \brief Result of an asynchronous operation, available once it completes.
+    *
+    * Unlike std::future, a continuation can be attached with then(), which
+    * runs when the result is set instead of blocking a thread on get().
+    * The result is retrieved once, by get() or by the continuation.
+    */
+    template<typename T>
+    class future
+    {
+        // Friends
+        template<typename U> friend class future;
+        friend class promise<T>;
+
+    public:
+        // Typedefs
+        typedef T value_type;
+
+        // Constructors & Destructors
+        future()
+        {};
+
+        // Methods
+        /*!
+        * \brief Returns whether the future refers to a result, which neither get() nor then() has taken yet.
+        */
+        bool valid() const
+        {
+            return state_ != nullptr;
+        }
+
+        /*!
+        * \brief Returns whether the result is set, without blocking.
+        */
+        bool is_ready() const
+        {
+            return checked().is_ready();
+        }
+
+        /*!
+        * \brief Blocks until the result is set.
+        */
+        void wait() const
+        {
+            checked().wait();
+        }
+
+        /*!
+        * \brief Blocks until the result is set and returns it, or rethrows the exception of the operation.
+        *
+        * The future is no longer valid afterwards.
+        */
+        T get()
+        {
+            std::shared_ptr<detail::shared_state<T> > state = std::move(state_);
+            if (state == nullptr) no_state();
+            return state->take();
+        }
+
+        /*!
+        * \brief Returns the future of fn(result), called on ex once the result is set.
+        *
+        * fn takes the result by value, or no argument for a future<void>. If
+        * the operation failed, fn is not called and the returned future holds
+        * the same exception. The future is no longer valid afterwards.
+        */
+        template<typename Executor, typename Function>
+        future<typename detail::continuation_result<T, Function>::type> then(Executor& ex, Function fn)
+        {
+            typedef typename detail::continuation_result<T, Function>::type R;
+
+            std::shared_ptr<detail::shared_state<T> > antecedent = std::move(state_);
+            if (antecedent == nullptr) no_state();
+
+            future<R> result(std::make_shared<detail::shared_state<R> >());
+            std::shared_ptr<detail::shared_state<R> > next = result.state_;
+
+            Executor* e = &ex;
+            antecedent->on_ready([e, antecedent, next, fn]() mutable
+            {
+                if (std::exception_ptr error = antecedent->error())
+                {
+                    next->set_error(error);
+                    return;
+                }
+                e->execute([antecedent, next, fn]() mutable { detail::continue_with(*next, *antecedent, fn); });
+            });
+
+            return result;
+        }
+
+        /*!
+        * \brief Same as then(ex, fn) but calls fn on the thread setting the result, or at once if it is set.
+        */
+        template<typename Function>
+        future<typename detail::continuation_result<T, Function>::type> then(Function fn)
+        {
+            inline_executor ex;
+            return then(ex, fn);
+        }
+
+    private:
+        std::shared_ptr<detail::shared_state<T> > state_;
+
+        explicit future(std::shared_ptr<detail::shared_state<T> > state) : state_(std::move(state))
+        {};
+
+        const detail::shared_state<T>& checked() const
+        {
+            if (state_ == nullptr) no_state();
+            return *state_;
+        }
+
+        static void no_state()
+        {
+            throw std::logic_error("std::logic_error: future has no state.");
+        }
+    };
+
+    /*!
+    * \brief Sets the result of a future, once.
+    *
+    * Copies share the result. If the last of them is destroyed before it
+    * is set, the future holds a std::future_error with broken_promise,
+    * as with std::promise, instead of waiting forever.
+    */
+    template<typename T>
+    class promise
+    {
+    public:
+        // Constructors & Destructors
+        promise() : owner_(std::make_shared<detail::promise_owner<T> >())
+        {};
+
+        // Methods
+        /*!
+        * \brief Returns the future of the result of this promise.
+        */
+        future<T> get_future() const
+        {
+            return future<T>(owner_->state);
+        }
+
+        /*!
+        * \brief Sets the result, then runs the continuations waiting for it. Takes no argument for a promise<void>.
+        */
+        template<typename... Value>
+        void set_value(Value&&... v)
+        {
+            owner_->state->set_value(std::forward<Value>(v)...);
+        }
+
+        /*!
+        * \brief Sets an exception as the result, then runs the continuations waiting for it.
+        */
+        void set_exception(std::exception_ptr e)
+        {
+            owner_->state->set_error(e);
+        }
+
+    private:
+        // copies share it, so that the result is abandoned only when the last of them is destroyed without setting it
+        std::shared_ptr<detail::promise_owner<T> > owner_;
+    };
+
+    // Algorithms
+    /*!
+    * \brief Calls fn(container) for each container of hv, as one task of ex per container.
+    *
+    * Returns at once. fn must be safe to call from several threads at once
+    * on different containers, and hv must outlive the returned future,
+    * which completes after every container, or holds the first exception
+    * thrown by fn.
+    */
+    template<typename T, typename... Types, typename Executor, typename Function>
+    future<void> async_for_each(vector<T, Types...>& hv, Executor& ex, Function fn)
+    {
+        promise<void> p;
+        future<void> result = p.get_future();
+
+        detail::async_lanes(hv, ex, std::make_shared<Function>(std::move(fn)), [p](std::exception_ptr error) mutable
+        {
+            if (error) p.set_exception(error);
+            else p.set_value();
+        });
+
+        return result;
+    }
+
+    /*!
+    * \brief Returns the future of whether fn(container) is true for each container of hv, evaluated as tasks of ex.
+    *
+    * Containers not yet evaluated once fn returned false for one are skipped.
+    */
+    template<typename T, typename... Types, typename Executor, typename Function>
+    future<bool> async_all_of(vector<T, Types...>& hv, Executor& ex, Function fn)
+    {
+        promise<bool> p;
+        future<bool> result = p.get_future();
+
+        auto all = std::make_shared<std::atomic<bool> >(true);
+        auto test = [all, fn](auto& C) mutable
+        {
+            if (all->load() && !fn(C)) all->store(false);
+        };
+
+        detail::async_lanes(hv, ex, std::make_shared<decltype(test)>(std::move(test)), [p, all](std::exception_ptr error) mutable
+        {
+            if (error) p.set_exception(error);
+            else p.set_value(all->load());
+        });
+
+        return result;
+    }
+
+    /*!
+    * \brief Returns the future of whether fn(container) is true for any container of hv, evaluated as tasks of ex.
+    *
+    * Containers not yet evaluated once fn returned true for one are skipped.
+    */
+    template<typename T, typename... Types, typename Executor, typename Function>
+    future<bool> async_any_of(vector<T, Types...>& hv, Executor& ex, Function fn)
+    {
+        promise<bool> p;
+        future<bool> result = p.get_future();
+
+        auto any = std::make_shared<std::atomic<bool> >(false);
+        auto test = [any, fn](auto& C) mutable
+        {
+            if (!any->load() && fn(C)) any->store(true);
+        };
+
+        detail::async_lanes(hv, ex, std::make_shared<decltype(test)>(std::move(test)), [p, any](std::exception_ptr error) mutable
+        {
+            if (error) p.set_exception(error);
+            else p.set_value(any->load());
+        });
+
+        return result;
+    }
+
+    /*!
+    * \brief Returns the future of whether fn(container) is false for every container of hv, evaluated as tasks of ex.
+    */
+    template<typename T, typename... Types, typename Executor, typename Function>
+    future<bool> async_none_of(vector<T, Types...>& hv, Executor& ex, Function fn)
+    {
+        return async_any_of(hv, ex, fn).then([](bool any) { return !any; });
+    }
+
+    /*!
+    * \brief Returns the future of transform_reduce_lanes(hv, init, reduce_op, transform_op), with transform_op evaluated as tasks of ex.
+    *
+    * transform_op must be safe to call from several threads at once on
+    * different containers. Its results are combined in container order by
+    * the task finishing last, so reduce_op need be neither associative nor
+    * commutative.
+    */
+    template<typename T, typename... Types, typename Executor, typename Result, typename BinaryOp, typename UnaryOp>
+    future<Result> async_transform_reduce_lanes(vector<T, Types...>& hv, Executor& ex, Result init, BinaryOp reduce_op, UnaryOp transform_op)
+    {
+        promise<Result> p;
+        future<Result> result = p.get_future();
+
+        detail::async_transform_reduce(hv, ex, p, std::move(init), std::move(reduce_op), std::move(transform_op), std::index_sequence_for<T, Types...>());
+        return result;
+    }
+
+    /*!
+    * \brief Returns the future of the elements of the Nth container of type U in hv combined by op, starting from init, computed as a task of ex.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Executor, typename BinaryOp = std::plus<U> >
+    future<U> async_reduce(vector<T, Types...>& hv, Executor& ex, U init, BinaryOp op = BinaryOp())
+    {
+        promise<U> p;
+        future<U> result = p.get_future();
+
+        const std::vector<U>* c = &hv.template get<U, N>();
+        ex.execute([c, p, init, op]() mutable
+        {
+            auto accumulate = [c, &init, &op]()
+            {
+                for (const U& x : *c) init = op(std::move(init), x);
+                return std::move(init);
+            };
+            detail::fulfil_promise(p, accumulate);
+        });
+
+        return result;
+    }
+}
+
+#endif // HETEROGENEOUS_ASYNC
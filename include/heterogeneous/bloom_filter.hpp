@@ -0,0 +1,310 @@
+#ifndef HETEROGENEOUS_BLOOM_FILTER
+#define HETEROGENEOUS_BLOOM_FILTER
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file bloom_filter.hpp
+*
+* Blocked Bloom filter of a container of a heterogeneous::vector, answering
+* "definitely absent" membership queries without scanning the container.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "../heterogeneous.hpp"
+#include "observer.hpp"
+
+namespace heterogeneous
+{
+    namespace detail
+    {
+        /*!
+        * \brief Allocator returning storage aligned to Align bytes.
+        */
+        template<typename T, size_t Align>
+        struct aligned_allocator
+        {
+            typedef T value_type;
+
+            template<typename U>
+            struct rebind
+            {
+                typedef aligned_allocator<U, Align> other;
+            };
+
+            aligned_allocator()
+            {};
+
+            template<typename U>
+            aligned_allocator(const aligned_allocator<U, Align>&)
+            {};
+
+            T* allocate(size_t n)
+            {
+                // the unaligned pointer is stored just before the aligned block
+                char* raw = static_cast<char*>(::operator new(n * sizeof(T) + Align + sizeof(void*)));
+                char* p = raw + sizeof(void*);
+                p += (Align - reinterpret_cast<std::uintptr_t>(p) % Align) % Align;
+                reinterpret_cast<void**>(p)[-1] = raw;
+                return reinterpret_cast<T*>(p);
+            }
+
+            void deallocate(T* p, size_t)
+            {
+                ::operator delete(reinterpret_cast<void**>(p)[-1]);
+            }
+
+            template<typename U>
+            bool operator==(const aligned_allocator<U, Align>&) const { return true; }
+
+            template<typename U>
+            bool operator!=(const aligned_allocator<U, Align>&) const { return false; }
+        };
+    }
+
+    /*!
+    * \brief Split block Bloom filter over the elements of a container.
+    *
+    * Each element sets one bit in each of the eight 64-bit words of a single
+    * 64 byte block, so a query touches exactly one cache line and the eight
+    * word tests are evaluated together (with AVX2 when available).
+    *
+    * The filter is sized from the false positive probability of this layout
+    * rather than the textbook formula, which underestimates it. Whenever more
+    * elements are appended than it was sized for, it grows and is rebuilt
+    * from the container, keeping the requested rate. Any T with a Hash works.
+    */
+    template<typename T, typename Hash = std::hash<T> >
+    class bloom_filter : public lane_observer<bloom_filter<T, Hash>, T>
+    {
+        // Friends
+        friend class lane_observer<bloom_filter<T, Hash>, T>;
+
+    public:
+        // Typedefs
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Builds a Bloom filter of c.
+        *
+        * @param fpp Target false positive probability, within (0, 1).
+        * @param capacity Number of elements to size the filter for. Defaults to the size of c.
+        */
+        explicit bloom_filter(const container_type& c, double fpp = 0.01, size_t capacity = 0, const Hash& hash = Hash())
+            : lane_observer<bloom_filter<T, Hash>, T>(c), hash_(hash), fpp_(fpp), capacity_(0), blocks_(0)
+        {
+            if (!(fpp > 0.0 && fpp < 1.0))
+                throw std::invalid_argument("std::invalid_argument: bloom_filter false positive probability must lie within (0, 1).");
+
+            resize(capacity > c.size() ? capacity : c.size());
+            this->sync();
+        };
+
+        // Methods
+        /*!
+        * \brief Returns false if v is definitely not in the container.
+        */
+        bool might_contain(const value_type& v)
+        {
+            this->sync();
+
+            const std::uint64_t h = mix(hash_(v));
+            return test(block(h), static_cast<std::uint32_t>(h));
+        }
+
+        /*!
+        * \brief Returns the requested false positive probability.
+        */
+        double false_positive_probability() const
+        {
+            return fpp_;
+        }
+
+        /*!
+        * \brief Returns the number of elements the filter is currently sized for.
+        */
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        /*!
+        * \brief Returns the size of the filter in bytes.
+        */
+        size_t bytes() const
+        {
+            return blocks_ * block_words * sizeof(std::uint64_t);
+        }
+
+    private:
+        static const size_t block_words = 8;
+
+        Hash hash_;
+        double fpp_;
+        size_t capacity_;
+        size_t blocks_;
+        std::vector<std::uint64_t, detail::aligned_allocator<std::uint64_t, 64> > storage_;
+
+        static std::uint64_t mix(std::uint64_t h)
+        {
+            // std::hash is the identity for integers on common implementations
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        std::uint64_t* block(std::uint64_t h)
+        {
+            const std::uint64_t b = ((h >> 32) * static_cast<std::uint64_t>(blocks_)) >> 32;
+            return storage_.data() + b * block_words;
+        }
+
+#if defined(__AVX2__)
+        static __m256i masks(std::uint32_t key, int half)
+        {
+            const __m256i salt = _mm256_setr_epi32(
+                0x47b6137b, 0x44974d91, static_cast<int>(0x8824ad5b), static_cast<int>(0xa2b7289d),
+                0x705495c7, 0x2df1424b, static_cast<int>(0x9efc4947), 0x5c6bfb31);
+
+            const __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salt), 26);
+            const __m128i four = half == 0 ? _mm256_castsi256_si128(bits) : _mm256_extracti128_si256(bits, 1);
+
+            return _mm256_sllv_epi64(_mm256_set1_epi64x(1), _mm256_cvtepu32_epi64(four));
+        }
+
+        static bool test(const std::uint64_t* w, std::uint32_t key)
+        {
+            const __m256i lo = _mm256_load_si256(reinterpret_cast<const __m256i*>(w));
+            const __m256i hi = _mm256_load_si256(reinterpret_cast<const __m256i*>(w + 4));
+
+            return (_mm256_testc_si256(lo, masks(key, 0)) & _mm256_testc_si256(hi, masks(key, 1))) != 0;
+        }
+
+        static void set(std::uint64_t* w, std::uint32_t key)
+        {
+            __m256i* lo = reinterpret_cast<__m256i*>(w);
+            __m256i* hi = reinterpret_cast<__m256i*>(w + 4);
+
+            _mm256_store_si256(lo, _mm256_or_si256(_mm256_load_si256(lo), masks(key, 0)));
+            _mm256_store_si256(hi, _mm256_or_si256(_mm256_load_si256(hi), masks(key, 1)));
+        }
+#else
+        static std::uint64_t mask(std::uint32_t key, size_t i)
+        {
+            static const std::uint32_t salt[block_words] = {
+                0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U };
+
+            return std::uint64_t(1) << ((key * salt[i]) >> 26);
+        }
+
+        static bool test(const std::uint64_t* w, std::uint32_t key)
+        {
+            // no early exit, the fixed length loop vectorizes
+            std::uint64_t missing = 0;
+            for (size_t i = 0; i < block_words; ++i) missing |= mask(key, i) & ~w[i];
+            return missing == 0;
+        }
+
+        static void set(std::uint64_t* w, std::uint32_t key)
+        {
+            for (size_t i = 0; i < block_words; ++i) w[i] |= mask(key, i);
+        }
+#endif
+
+        static double expected_fpp(double bits_per_element)
+        {
+            // elements per block are Poisson distributed; a block holding x
+            // elements answers a foreign query positively with (1 - (63/64)^x)^8
+            const double lambda = 64.0 * block_words / bits_per_element;
+            const size_t limit = static_cast<size_t>(lambda + 10.0 * std::sqrt(lambda)) + 20;
+
+            double poisson = std::exp(-lambda);
+            double result = 0.0;
+            for (size_t x = 1; x < limit; ++x)
+            {
+                poisson *= lambda / static_cast<double>(x);
+                result += poisson * std::pow(1.0 - std::pow(63.0 / 64.0, static_cast<double>(x)), static_cast<double>(block_words));
+            }
+
+            return result;
+        }
+
+        void resize(size_t capacity)
+        {
+            if (capacity < 1024) capacity = 1024;
+
+            // smallest number of bits per element meeting fpp_
+            double lo = 1.0, hi = 256.0;
+            for (int i = 0; i < 32; ++i)
+            {
+                const double mid = 0.5 * (lo + hi);
+                if (expected_fpp(mid) > fpp_) lo = mid;
+                else hi = mid;
+            }
+
+            capacity_ = capacity;
+            blocks_ = static_cast<size_t>(std::ceil(hi * static_cast<double>(capacity) / (64.0 * block_words)));
+            storage_.assign(blocks_ * block_words, 0);
+        }
+
+        void absorb(size_t first, size_t last)
+        {
+            if (last > capacity_)
+            {
+                // grow geometrically and re-insert everything observed so far
+                resize(last > 2 * capacity_ ? last : 2 * capacity_);
+                first = 0;
+            }
+
+            const container_type& c = *this->container();
+            for (size_t i = first; i < last; ++i)
+            {
+                const std::uint64_t h = mix(hash_(c[i]));
+                set(block(h), static_cast<std::uint32_t>(h));
+            }
+        }
+
+        void reset()
+        {
+            std::fill(storage_.begin(), storage_.end(), 0);
+        }
+    };
+
+    /*!
+    * \brief Returns a bloom_filter of the Nth container of type U in hv.
+    *
+    * The filter watches hv.generation(), so removed elements stop matching
+    * once rows of hv are rewritten or removed in place.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    bloom_filter<U> make_bloom_filter(vector<T, Types...>& hv, double fpp = 0.01, size_t capacity = 0)
+    {
+        bloom_filter<U> result(hv.template get<U, N>(), fpp, capacity);
+        result.watch(hv.generation());
+        return result;
+    }
+}
+
+#endif // HETEROGENEOUS_BLOOM_FILTER
@@ -0,0 +1,323 @@
+#ifndef HETEROGENEOUS_DYNAMIC
+#define HETEROGENEOUS_DYNAMIC
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file dynamic.hpp
+*
+* dynamic_vector, a heterogeneous container whose containers are added
+* and removed at runtime, one per element type. Each container is a
+* typed std::vector, unlike a std::vector<boost::any>, and is found by
+* its std::type_index in an open addressing hash table.
+*/
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        struct lane_base
+        {
+            virtual ~lane_base() {}
+            virtual std::type_index type() const = 0;
+            virtual size_t size() const = 0;
+            virtual void clear() = 0;
+            virtual std::unique_ptr<lane_base> clone() const = 0;
+        };
+
+        template<typename U>
+        struct lane_impl : lane_base
+        {
+            std::vector<U> data;
+
+            std::type_index type() const { return std::type_index(typeid(U)); }
+            size_t size() const { return data.size(); }
+            void clear() { data.clear(); }
+            std::unique_ptr<lane_base> clone() const { return std::unique_ptr<lane_base>(new lane_impl<U>(*this)); }
+        };
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief Heterogeneous container with one std::vector per element type, the types being chosen at runtime.
+    *
+    * Finding the container of a type hashes its std::type_index once and
+    * probes a table of at most half full slots, usually one slot. Callers
+    * accessing the same container repeatedly can keep a handle instead,
+    * which refers to the container directly.
+    */
+    class dynamic_vector
+    {
+    public:
+        /*!
+        * \brief Direct reference to the container of type U of a dynamic_vector.
+        *
+        * Remains valid as the dynamic_vector gains containers, until the
+        * container of type U is removed or the dynamic_vector destroyed.
+        */
+        template<typename U>
+        class handle
+        {
+        public:
+            handle() : container_(nullptr)
+            {};
+
+            explicit handle(std::vector<U>& c) : container_(&c)
+            {};
+
+            std::vector<U>& operator*() const { return *container_; }
+            std::vector<U>* operator->() const { return container_; }
+            std::vector<U>& get() const { return *container_; }
+            explicit operator bool() const { return container_ != nullptr; }
+
+        private:
+            std::vector<U>* container_;
+        };
+
+        // Constructors & Destructors
+        dynamic_vector() : slots_(8), size_(0)
+        {};
+
+        dynamic_vector(const dynamic_vector& x) : slots_(x.slots_), size_(x.size_)
+        {
+            lanes_.reserve(x.lanes_.size());
+            for (const auto& lane : x.lanes_) lanes_.push_back(lane ? lane->clone() : nullptr);
+        };
+
+        dynamic_vector(dynamic_vector&& x) : dynamic_vector()
+        {
+            swap(x);
+        };
+
+        // Operators
+        dynamic_vector& operator=(dynamic_vector x)
+        {
+            swap(x);
+            return *this;
+        }
+
+        // Methods
+        /*!
+        * \brief Returns the number of containers.
+        */
+        size_t size() const
+        {
+            return size_;
+        }
+
+        /*!
+        * \brief Returns the types of the containers, in the order they were added.
+        */
+        std::vector<std::type_index> types() const
+        {
+            std::vector<std::type_index> result;
+            for (const auto& lane : lanes_) if (lane) result.push_back(lane->type());
+            return result;
+        }
+
+        /*!
+        * \brief Returns whether there is a container of the given type.
+        */
+        bool contains(std::type_index type) const
+        {
+            return find(type) != nullptr;
+        }
+
+        template<typename U>
+        bool contains() const
+        {
+            return contains(std::type_index(typeid(U)));
+        }
+
+        /*!
+        * \brief Returns the number of elements of the container of the given type.
+        *
+        * If there is no such container, throws std::invalid_argument exception.
+        */
+        size_t size(std::type_index type) const
+        {
+            const detail::lane_base* lane = find(type);
+            if (lane == nullptr) missing(type);
+            return lane->size();
+        }
+
+        /*!
+        * \brief Returns the container of type U, adding an empty one if there is none.
+        */
+        template<typename U>
+        std::vector<U>& add()
+        {
+            const std::type_index type(typeid(U));
+            if (detail::lane_base* lane = find(type)) return static_cast<detail::lane_impl<U>*>(lane)->data;
+
+            if (2 * (size_ + 1) > slots_.size()) rehash(2 * slots_.size());
+
+            detail::lane_impl<U>* lane = new detail::lane_impl<U>();
+            lanes_.push_back(std::unique_ptr<detail::lane_base>(lane));
+            place(type.hash_code(), lanes_.size() - 1);
+            ++size_;
+
+            return lane->data;
+        }
+
+        /*!
+        * \brief Returns the container of type U.
+        *
+        * If there is no such container, throws std::invalid_argument exception.
+        */
+        template<typename U>
+        std::vector<U>& get()
+        {
+            const std::type_index type(typeid(U));
+            detail::lane_base* lane = find(type);
+            if (lane == nullptr) missing(type);
+
+            return static_cast<detail::lane_impl<U>*>(lane)->data;
+        }
+
+        template<typename U>
+        const std::vector<U>& get() const
+        {
+            const std::type_index type(typeid(U));
+            const detail::lane_base* lane = find(type);
+            if (lane == nullptr) missing(type);
+
+            return static_cast<const detail::lane_impl<U>*>(lane)->data;
+        }
+
+        /*!
+        * \brief Returns a handle of the container of type U, for repeated access without lookups.
+        *
+        * If there is no such container, throws std::invalid_argument exception.
+        */
+        template<typename U>
+        handle<U> get_handle()
+        {
+            return handle<U>(get<U>());
+        }
+
+        /*!
+        * \brief Removes the container of the given type and its elements. Returns whether there was one.
+        *
+        * Handles of the removed container become invalid.
+        */
+        bool remove(std::type_index type)
+        {
+            const size_t h = type.hash_code();
+            for (size_t s = h & (slots_.size() - 1); slots_[s].lane != empty; s = (s + 1) & (slots_.size() - 1))
+            {
+                if (slots_[s].hash != h || lanes_[slots_[s].lane]->type() != type) continue;
+
+                lanes_[slots_[s].lane].reset();
+                --size_;
+
+                // rebuilding keeps probe sequences intact without tombstones; removal is rare
+                rehash(slots_.size());
+                return true;
+            }
+            return false;
+        }
+
+        template<typename U>
+        bool remove()
+        {
+            return remove(std::type_index(typeid(U)));
+        }
+
+        /*!
+        * \brief Removes every element of every container, keeping the containers.
+        */
+        void clear()
+        {
+            for (auto& lane : lanes_) if (lane) lane->clear();
+        }
+
+        /*!
+        * \brief Swaps contents of object with x.
+        */
+        void swap(dynamic_vector& x)
+        {
+            slots_.swap(x.slots_);
+            lanes_.swap(x.lanes_);
+            std::swap(size_, x.size_);
+        }
+
+    private:
+        static const size_t empty = static_cast<size_t>(-1);
+
+        struct slot
+        {
+            size_t hash;
+            size_t lane;
+
+            slot() : hash(0), lane(empty)
+            {};
+        };
+
+        std::vector<slot> slots_; // power of two many, at most half full
+        std::vector<std::unique_ptr<detail::lane_base> > lanes_; // in order of addition, null once removed
+        size_t size_;
+
+        detail::lane_base* find(std::type_index type) const
+        {
+            const size_t h = type.hash_code();
+            for (size_t s = h & (slots_.size() - 1); slots_[s].lane != empty; s = (s + 1) & (slots_.size() - 1))
+            {
+                // comparing the stored hash first avoids touching the lane of a colliding type
+                if (slots_[s].hash == h && lanes_[slots_[s].lane]->type() == type) return lanes_[slots_[s].lane].get();
+            }
+            return nullptr;
+        }
+
+        void place(size_t hash, size_t lane)
+        {
+            size_t s = hash & (slots_.size() - 1);
+            while (slots_[s].lane != empty) s = (s + 1) & (slots_.size() - 1);
+
+            slots_[s].hash = hash;
+            slots_[s].lane = lane;
+        }
+
+        void rehash(size_t slots)
+        {
+            // compact away removed lanes while rebuilding
+            std::vector<std::unique_ptr<detail::lane_base> > lanes;
+            for (auto& lane : lanes_) if (lane) lanes.push_back(std::move(lane));
+            lanes_.swap(lanes);
+
+            slots_.assign(slots, slot());
+            for (size_t i = 0; i < lanes_.size(); ++i) place(lanes_[i]->type().hash_code(), i);
+        }
+
+        static void missing(std::type_index type)
+        {
+            throw std::invalid_argument(std::string("Type ") + std::string(type.name()) + std::string(" does not exist in object."));
+        }
+    };
+
+    inline void swap(dynamic_vector& a, dynamic_vector& b)
+    {
+        a.swap(b);
+    }
+}
+
+#endif // HETEROGENEOUS_DYNAMIC
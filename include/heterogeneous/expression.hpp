@@ -0,0 +1,302 @@
+#ifndef HETEROGENEOUS_EXPRESSION
+#define HETEROGENEOUS_EXPRESSION
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file expression.hpp
+*
+* Expression templates for element-wise arithmetic between containers of
+* a heterogeneous::vector. An expression such as
+*
+*     expr(hv.get<double, 0>()) * expr(hv.get<double, 1>()) + 1.0
+*
+* is only a description of the computation; assign() evaluates it in a
+* single loop over the elements, writing straight into the destination.
+*/
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Base class of all expressions, E being the derived expression.
+    */
+    template<typename E>
+    struct expression
+    {
+        /*!
+        * \brief Size of expressions which repeat a single value, such as scalars.
+        */
+        static const size_t broadcast = static_cast<size_t>(-1);
+
+        const E& self() const
+        {
+            return *static_cast<const E*>(this);
+        }
+    };
+
+    /*!
+    * \brief Expression of the elements of a container.
+    */
+    template<typename T>
+    class terminal : public expression<terminal<T> >
+    {
+    public:
+        typedef T value_type;
+
+        explicit terminal(const std::vector<T>& c) : data_(c.data()), size_(c.size())
+        {};
+
+        const value_type& operator[](size_t i) const { return data_[i]; }
+        size_t size() const { return size_; }
+
+    private:
+        const T* data_;
+        size_t size_;
+    };
+
+    /*!
+    * \brief Expression repeating one value, broadcast against containers.
+    */
+    template<typename T>
+    class scalar : public expression<scalar<T> >
+    {
+    public:
+        typedef T value_type;
+
+        explicit scalar(const T& v) : value_(v)
+        {};
+
+        const value_type& operator[](size_t) const { return value_; }
+        size_t size() const { return expression<scalar<T> >::broadcast; }
+
+    private:
+        T value_;
+    };
+
+    /*!
+    * \brief Expression applying fn to each element of E.
+    */
+    template<typename E, typename Function>
+    class unary_expression : public expression<unary_expression<E, Function> >
+    {
+    public:
+        typedef typename std::decay<decltype(std::declval<const Function&>()(std::declval<const E&>()[0]))>::type value_type;
+
+        unary_expression(const E& e, Function fn) : e_(e), fn_(fn)
+        {};
+
+        value_type operator[](size_t i) const { return fn_(e_[i]); }
+        size_t size() const { return e_.size(); }
+
+    private:
+        E e_;
+        Function fn_;
+    };
+
+    /*!
+    * \brief Expression applying fn to corresponding elements of L and R.
+    *
+    * Throws std::invalid_argument if L and R hold different numbers of elements.
+    */
+    template<typename L, typename R, typename Function>
+    class binary_expression : public expression<binary_expression<L, R, Function> >
+    {
+    public:
+        typedef typename std::decay<decltype(std::declval<const Function&>()(std::declval<const L&>()[0], std::declval<const R&>()[0]))>::type value_type;
+
+        binary_expression(const L& l, const R& r, Function fn) : l_(l), r_(r), fn_(fn)
+        {
+            const size_t broadcast = expression<binary_expression>::broadcast;
+            if (l_.size() != broadcast && r_.size() != broadcast && l_.size() != r_.size())
+                throw std::invalid_argument(std::string("std::invalid_argument: Expression operands hold ") + std::to_string(l_.size()) + std::string(" and ") + std::to_string(r_.size()) + std::string(" elements."));
+        };
+
+        value_type operator[](size_t i) const { return fn_(l_[i], r_[i]); }
+        size_t size() const { return l_.size() != expression<binary_expression>::broadcast ? l_.size() : r_.size(); }
+
+    private:
+        L l_;
+        R r_;
+        Function fn_;
+    };
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        struct plus { template<typename A, typename B> auto operator()(const A& a, const B& b) const { return a + b; } };
+        struct minus { template<typename A, typename B> auto operator()(const A& a, const B& b) const { return a - b; } };
+        struct multiplies { template<typename A, typename B> auto operator()(const A& a, const B& b) const { return a * b; } };
+        struct divides { template<typename A, typename B> auto operator()(const A& a, const B& b) const { return a / b; } };
+        struct negate { template<typename A> auto operator()(const A& a) const { return -a; } };
+
+        template<typename S>
+        using enable_if_scalar = typename std::enable_if<std::is_arithmetic<S>::value>::type;
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief Returns an expression of the elements of c.
+    *
+    * The expression refers to the elements of c, which must not be
+    * reallocated while it is in use.
+    */
+    template<typename T>
+    terminal<T> expr(const std::vector<T>& c)
+    {
+        return terminal<T>(c);
+    }
+
+    /*!
+    * \brief Returns an expression of the elements of the Nth container of type U in hv.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    terminal<U> expr(vector<T, Types...>& hv)
+    {
+        return terminal<U>(hv.template get<U, N>());
+    }
+
+    /*!
+    * \brief Returns an expression applying fn to each element of e.
+    */
+    template<typename E, typename Function>
+    unary_expression<E, Function> map(const expression<E>& e, Function fn)
+    {
+        return unary_expression<E, Function>(e.self(), fn);
+    }
+
+    template<typename E>
+    unary_expression<E, detail::negate> operator-(const expression<E>& e)
+    {
+        return unary_expression<E, detail::negate>(e.self(), detail::negate());
+    }
+
+#define HETEROGENEOUS_EXPRESSION_OPERATOR(op, function)                                             \
+    template<typename L, typename R>                                                               \
+    binary_expression<L, R, function> operator op(const expression<L>& l, const expression<R>& r)  \
+    {                                                                                              \
+        return binary_expression<L, R, function>(l.self(), r.self(), function());                  \
+    }                                                                                              \
+                                                                                                   \
+    template<typename L, typename S, typename = detail::enable_if_scalar<S> >                      \
+    binary_expression<L, scalar<S>, function> operator op(const expression<L>& l, const S& r)      \
+    {                                                                                              \
+        return binary_expression<L, scalar<S>, function>(l.self(), scalar<S>(r), function());      \
+    }                                                                                              \
+                                                                                                   \
+    template<typename S, typename R, typename = detail::enable_if_scalar<S> >                      \
+    binary_expression<scalar<S>, R, function> operator op(const S& l, const expression<R>& r)      \
+    {                                                                                              \
+        return binary_expression<scalar<S>, R, function>(scalar<S>(l), r.self(), function());      \
+    }
+
+    HETEROGENEOUS_EXPRESSION_OPERATOR(+, detail::plus)
+    HETEROGENEOUS_EXPRESSION_OPERATOR(-, detail::minus)
+    HETEROGENEOUS_EXPRESSION_OPERATOR(*, detail::multiplies)
+    HETEROGENEOUS_EXPRESSION_OPERATOR(/, detail::divides)
+
+#undef HETEROGENEOUS_EXPRESSION_OPERATOR
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        template<typename T, typename E>
+        void evaluate(T* out, const E& e, size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i) out[i] = e[i];
+        }
+
+        template<typename T, typename E>
+        size_t resize_for(std::vector<T>& dst, const expression<E>& e)
+        {
+            const size_t n = e.self().size();
+            if (n == expression<E>::broadcast)
+                throw std::invalid_argument("std::invalid_argument: Expression does not refer to any container.");
+
+            dst.resize(n);
+            return n;
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Evaluates e into dst, resizing dst to the size of e.
+    *
+    * dst may itself appear in e.
+    */
+    template<typename T, typename E>
+    void assign(std::vector<T>& dst, const expression<E>& e)
+    {
+        const size_t n = detail::resize_for(dst, e);
+        detail::evaluate(dst.data(), e.self(), 0, n);
+    }
+
+    /*!
+    * \brief Evaluates e into dst, splitting the elements across threads.
+    */
+    template<typename T, typename E>
+    void assign(std::vector<T>& dst, const expression<E>& e, parallel_policy)
+    {
+        const size_t n = detail::resize_for(dst, e);
+
+        T* out = dst.data();
+        const E& self = e.self();
+
+        // below a few pages per thread, spawning costs more than it saves
+        detail::parallel_for(n, 1 << 16, [out, &self](size_t first, size_t last)
+        {
+            detail::evaluate(out, self, first, last);
+        });
+    }
+
+    template<typename T, typename E>
+    void assign(std::vector<T>& dst, const expression<E>& e, sequential_policy)
+    {
+        assign(dst, e);
+    }
+
+    /*!
+    * \brief Evaluates e into the Nth container of type U in hv and advances hv.generation().
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename E, typename Policy = sequential_policy>
+    void assign(vector<T, Types...>& hv, const expression<E>& e, Policy policy = Policy())
+    {
+        assign(hv.template get<U, N>(), e, policy);
+        hv.touch();
+    }
+
+    /*!
+    * \brief Returns a new container holding the elements of e.
+    */
+    template<typename E, typename Policy = sequential_policy>
+    std::vector<typename E::value_type> evaluate(const expression<E>& e, Policy policy = Policy())
+    {
+        std::vector<typename E::value_type> result;
+        assign(result, e, policy);
+        return result;
+    }
+}
+
+#endif // HETEROGENEOUS_EXPRESSION
@@ -0,0 +1,569 @@
+#ifndef HETEROGENEOUS_FLAT
+#define HETEROGENEOUS_FLAT
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file flat.hpp
+*
+* Sorted containers of a heterogeneous::vector used as sets (flat_set)
+* or, paired with a second container, as maps (flat_map). Batches of
+* elements are inserted with one sort and one merge pass instead of one
+* shifting insert each, and lookups use a branchless binary search, an
+* Eytzinger (breadth first) layout or interpolation search.
+*/
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "rows.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Search tag selecting a branchless binary search, the default.
+    */
+    struct branchless_search
+    {};
+
+    /*!
+    * \brief Search tag selecting a search of an Eytzinger layout of the keys, built on first use.
+    *
+    * The layout stores the implicit search tree breadth first, so the
+    * elements compared next are adjacent in memory and can be prefetched;
+    * it pays off for large containers searched many times between changes.
+    */
+    struct eytzinger_search
+    {};
+
+    /*!
+    * \brief Search tag selecting interpolation search, for arithmetic keys ordered by std::less.
+    *
+    * Takes O(log log n) probes for uniformly distributed keys and falls back
+    * to bisection when interpolation does not narrow the range quickly.
+    */
+    struct interpolation_search
+    {};
+
+    const branchless_search branchless = branchless_search();
+    const eytzinger_search eytzinger = eytzinger_search();
+    const interpolation_search interpolation = interpolation_search();
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        /*!
+        * \brief Index of the first of n sorted elements at first not ordered before key.
+        *
+        * The loop runs a fixed log2(n) times and selects with a conditional
+        * move rather than a branch the processor would mispredict.
+        */
+        template<typename T, typename Compare>
+        size_t branchless_lower_bound(const T* first, size_t n, const T& key, const Compare& cmp)
+        {
+            if (n == 0) return 0;
+
+            const T* base = first;
+            while (n > 1)
+            {
+                const size_t half = n / 2;
+
+                // both possible next probes, so that the memory latency overlaps the comparison
+                prefetch(base + half / 2);
+                prefetch(base + half + half / 2);
+                base = cmp(base[half], key) ? base + half : base;
+                n -= half;
+            }
+            return (base - first) + (cmp(*base, key) ? 1 : 0);
+        }
+
+        template<typename T>
+        size_t interpolation_lower_bound(const T* first, size_t n, const T& key)
+        {
+            static_assert(std::is_arithmetic<T>::value, "interpolation search requires arithmetic keys.");
+
+            // the answer lies within [lo, hi]
+            size_t lo = 0, hi = n;
+            bool bisect = false;
+            while (hi - lo > 16)
+            {
+                const T low = first[lo], high = first[hi - 1];
+                if (!(low < key)) return lo;
+                if (high < key) return hi;
+
+                size_t pos = lo + (hi - lo) / 2;
+                if (!bisect && low < high)
+                {
+                    // infinite keys or overflowing differences give a NaN or infinite fraction; bisect then
+                    const double fraction = (static_cast<double>(key) - static_cast<double>(low)) / (static_cast<double>(high) - static_cast<double>(low));
+                    if (fraction >= 0.0 && fraction <= 1.0)
+                    {
+                        pos = lo + static_cast<size_t>(fraction * static_cast<double>(hi - 1 - lo));
+                        pos = std::min(std::max(pos, lo), hi - 1);
+                    }
+                }
+
+                const size_t before = hi - lo;
+                if (first[pos] < key) lo = pos + 1;
+                else hi = pos;
+
+                // skewed keys: alternate with bisection while interpolation makes little progress
+                bisect = !bisect && hi - lo > before / 2;
+            }
+            return lo + branchless_lower_bound(first + lo, hi - lo, key, std::less<T>());
+        }
+
+        /*!
+        * \brief Copy of sorted keys in Eytzinger order, with the sorted position of each.
+        */
+        template<typename T>
+        class eytzinger_layout
+        {
+        public:
+            eytzinger_layout() : size_(0), valid_(false)
+            {};
+
+            bool valid(size_t n) const
+            {
+                return valid_ && size_ == n;
+            }
+
+            void invalidate()
+            {
+                valid_ = false;
+            }
+
+            void build(const T* sorted, size_t n)
+            {
+                size_ = n;
+                keys_.assign(n + 1, T());
+                positions_.assign(n + 1, n);
+                fill(sorted, 0, 1);
+                valid_ = true;
+            }
+
+            template<typename Compare>
+            size_t lower_bound(const T& key, const Compare& cmp) const
+            {
+                size_t k = 1;
+                while (k <= size_)
+                {
+                    if (16 * k <= size_) prefetch(&keys_[16 * k]);
+                    k = 2 * k + (cmp(keys_[k], key) ? 1 : 0);
+                }
+
+                // the answer is the node of the last left turn: undo the right turns after it, then the turn itself
+                while (k & 1) k >>= 1;
+                k >>= 1;
+                return k == 0 ? size_ : positions_[k];
+            }
+
+        private:
+            size_t size_;
+            bool valid_;
+            std::vector<T> keys_; // 1-based, node k has children 2k and 2k + 1
+            std::vector<size_t> positions_;
+
+            size_t fill(const T* sorted, size_t i, size_t k)
+            {
+                if (k > size_) return i;
+
+                i = fill(sorted, i, 2 * k);
+                keys_[k] = sorted[i];
+                positions_[k] = i;
+                return fill(sorted, i + 1, 2 * k + 1);
+            }
+        };
+
+        /*!
+        * \brief Merges sorted elements [added_first, added_last) into the sorted prefix of c, which already has room for them at its end.
+        *
+        * Merging from the back moves each element once, in place.
+        */
+        template<typename T, typename Iterator, typename Compare>
+        void merge_backward(std::vector<T>& c, size_t old_size, Iterator added_first, Iterator added_last, const Compare& cmp)
+        {
+            size_t out = c.size();
+            size_t i = old_size;
+            while (added_last != added_first)
+            {
+                if (i > 0 && cmp(*std::prev(added_last), c[i - 1])) c[--out] = std::move(c[--i]);
+                else c[--out] = *--added_last;
+            }
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief Set of unique elements kept sorted in a container, usually a container of a heterogeneous::vector.
+    *
+    * The container must only change through the set, apart from changes
+    * followed by sort(). Single insertions and erasures shift the elements
+    * after them; batches are merged in one pass.
+    */
+    template<typename T, typename Compare = std::less<T> >
+    class flat_set
+    {
+    public:
+        // Typedefs
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+        typedef Compare value_compare;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Uses c as the set, sorting it and removing duplicates.
+        */
+        explicit flat_set(container_type& c, const Compare& cmp = Compare()) : container_(&c), cmp_(cmp)
+        {
+            sort();
+        };
+
+        // Methods
+        const container_type& container() const { return *container_; }
+        size_t size() const { return container_->size(); }
+        bool empty() const { return container_->empty(); }
+
+        /*!
+        * \brief Sorts the container and removes duplicates, after it was modified directly.
+        */
+        void sort()
+        {
+            std::sort(container_->begin(), container_->end(), cmp_);
+            container_->erase(std::unique(container_->begin(), container_->end(), [this](const T& a, const T& b) { return equivalent(a, b); }), container_->end());
+            layout_.invalidate();
+        }
+
+        /*!
+        * \brief Returns the index of the first element not ordered before v, size() if none.
+        */
+        size_t lower_bound(const value_type& v, branchless_search = branchless) const
+        {
+            return detail::branchless_lower_bound(container_->data(), container_->size(), v, cmp_);
+        }
+
+        size_t lower_bound(const value_type& v, eytzinger_search)
+        {
+            if (!layout_.valid(container_->size())) layout_.build(container_->data(), container_->size());
+            return layout_.lower_bound(v, cmp_);
+        }
+
+        size_t lower_bound(const value_type& v, interpolation_search) const
+        {
+            static_assert(std::is_same<Compare, std::less<T> >::value, "interpolation search requires keys ordered by std::less.");
+            return detail::interpolation_lower_bound(container_->data(), container_->size(), v);
+        }
+
+        /*!
+        * \brief Returns the index of v, size() if absent.
+        */
+        template<typename Search = branchless_search>
+        size_t find(const value_type& v, Search search = Search())
+        {
+            const size_t i = lower_bound(v, search);
+            return i < size() && !cmp_(v, (*container_)[i]) ? i : size();
+        }
+
+        template<typename Search = branchless_search>
+        bool contains(const value_type& v, Search search = Search())
+        {
+            return find(v, search) != size();
+        }
+
+        /*!
+        * \brief Inserts v if absent. Returns its index and whether it was inserted.
+        */
+        std::pair<size_t, bool> insert(const value_type& v)
+        {
+            const size_t i = lower_bound(v);
+            if (i < size() && !cmp_(v, (*container_)[i])) return std::make_pair(i, false);
+
+            container_->insert(container_->begin() + i, v);
+            layout_.invalidate();
+            return std::make_pair(i, true);
+        }
+
+        /*!
+        * \brief Inserts the elements of [first, last) which are absent, in O(m log m + n) for m elements into n.
+        *
+        * Returns the number of elements inserted.
+        */
+        template<typename Iterator>
+        size_t insert(Iterator first, Iterator last)
+        {
+            std::vector<T> batch(first, last);
+            std::sort(batch.begin(), batch.end(), cmp_);
+            batch.erase(std::unique(batch.begin(), batch.end(), [this](const T& a, const T& b) { return equivalent(a, b); }), batch.end());
+
+            // drop elements already present, then merge the rest from the back
+            batch.erase(std::remove_if(batch.begin(), batch.end(), [this](const T& v)
+            {
+                const size_t i = lower_bound(v);
+                return i < size() && !cmp_(v, (*container_)[i]);
+            }), batch.end());
+
+            const size_t old_size = size();
+            container_->resize(old_size + batch.size());
+            detail::merge_backward(*container_, old_size, batch.begin(), batch.end(), cmp_);
+
+            if (!batch.empty()) layout_.invalidate();
+            return batch.size();
+        }
+
+        /*!
+        * \brief Removes v if present. Returns whether it was.
+        */
+        bool erase(const value_type& v)
+        {
+            const size_t i = find(v);
+            if (i == size()) return false;
+
+            container_->erase(container_->begin() + i);
+            layout_.invalidate();
+            return true;
+        }
+
+    private:
+        container_type* container_;
+        Compare cmp_;
+        detail::eytzinger_layout<T> layout_;
+
+        bool equivalent(const T& a, const T& b) const
+        {
+            return !cmp_(a, b) && !cmp_(b, a);
+        }
+    };
+
+    /*!
+    * \brief Map kept in two containers of equal size, usually two containers of a heterogeneous::vector: sorted unique keys, and the value of each key at the same index.
+    *
+    * The containers must only change through the map, apart from changes
+    * followed by sort(). Batches of entries are merged in one pass.
+    */
+    template<typename K, typename V, typename Compare = std::less<K> >
+    class flat_map
+    {
+    public:
+        // Typedefs
+        typedef K key_type;
+        typedef V mapped_type;
+        typedef Compare key_compare;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Uses keys and values as the map, sorting them by key and keeping the first entry of each key.
+        *
+        * Throws std::invalid_argument if keys and values differ in size.
+        */
+        flat_map(std::vector<K>& keys, std::vector<V>& values, const Compare& cmp = Compare()) : keys_(&keys), values_(&values), cmp_(cmp)
+        {
+            sort();
+        };
+
+        // Methods
+        const std::vector<K>& keys() const { return *keys_; }
+        const std::vector<V>& values() const { return *values_; }
+        size_t size() const { return keys_->size(); }
+        bool empty() const { return keys_->empty(); }
+
+        /*!
+        * \brief Sorts the entries by key and keeps the first entry of each key, after the containers were modified directly.
+        */
+        void sort()
+        {
+            if (keys_->size() != values_->size())
+                throw std::invalid_argument("std::invalid_argument: flat_map keys and values hold different numbers of elements.");
+
+            std::vector<std::pair<K, V> > entries;
+            entries.reserve(size());
+            for (size_t i = 0; i < size(); ++i) entries.emplace_back(std::move((*keys_)[i]), std::move((*values_)[i]));
+
+            sort_entries(entries);
+            keys_->clear();
+            values_->clear();
+            for (auto& entry : entries)
+            {
+                keys_->push_back(std::move(entry.first));
+                values_->push_back(std::move(entry.second));
+            }
+            layout_.invalidate();
+        }
+
+        size_t lower_bound(const key_type& k, branchless_search = branchless) const
+        {
+            return detail::branchless_lower_bound(keys_->data(), keys_->size(), k, cmp_);
+        }
+
+        size_t lower_bound(const key_type& k, eytzinger_search)
+        {
+            if (!layout_.valid(keys_->size())) layout_.build(keys_->data(), keys_->size());
+            return layout_.lower_bound(k, cmp_);
+        }
+
+        size_t lower_bound(const key_type& k, interpolation_search) const
+        {
+            static_assert(std::is_same<Compare, std::less<K> >::value, "interpolation search requires keys ordered by std::less.");
+            return detail::interpolation_lower_bound(keys_->data(), keys_->size(), k);
+        }
+
+        /*!
+        * \brief Returns the index of key k, size() if absent.
+        */
+        template<typename Search = branchless_search>
+        size_t find(const key_type& k, Search search = Search())
+        {
+            const size_t i = lower_bound(k, search);
+            return i < size() && !cmp_(k, (*keys_)[i]) ? i : size();
+        }
+
+        template<typename Search = branchless_search>
+        bool contains(const key_type& k, Search search = Search())
+        {
+            return find(k, search) != size();
+        }
+
+        /*!
+        * \brief Returns the value of key k. Throws std::out_of_range if k is absent.
+        */
+        template<typename Search = branchless_search>
+        mapped_type& at(const key_type& k, Search search = Search())
+        {
+            const size_t i = find(k, search);
+            if (i == size())
+                throw std::out_of_range("std::out_of_range: Key does not exist in flat_map.");
+            return (*values_)[i];
+        }
+
+        /*!
+        * \brief Inserts (k, v) if k is absent. Returns the index of k and whether it was inserted.
+        */
+        std::pair<size_t, bool> insert(const key_type& k, const mapped_type& v)
+        {
+            const size_t i = lower_bound(k);
+            if (i < size() && !cmp_(k, (*keys_)[i])) return std::make_pair(i, false);
+
+            keys_->insert(keys_->begin() + i, k);
+            values_->insert(values_->begin() + i, v);
+            layout_.invalidate();
+            return std::make_pair(i, true);
+        }
+
+        /*!
+        * \brief Inserts the entries of [first, last), pairs of key and value, whose keys are absent.
+        *
+        * Of several entries with the same key the first is inserted. Runs in
+        * O(m log m + n) for m entries into n. Returns the number inserted.
+        */
+        template<typename Iterator>
+        size_t insert(Iterator first, Iterator last)
+        {
+            std::vector<std::pair<K, V> > batch(first, last);
+            sort_entries(batch);
+
+            batch.erase(std::remove_if(batch.begin(), batch.end(), [this](const std::pair<K, V>& entry)
+            {
+                const size_t i = lower_bound(entry.first);
+                return i < size() && !cmp_(entry.first, (*keys_)[i]);
+            }), batch.end());
+
+            // merge keys and values together from the back
+            const size_t old_size = size();
+            keys_->resize(old_size + batch.size());
+            values_->resize(old_size + batch.size());
+
+            size_t out = keys_->size();
+            size_t i = old_size;
+            for (size_t b = batch.size(); b > 0; )
+            {
+                --out;
+                if (i > 0 && cmp_(batch[b - 1].first, (*keys_)[i - 1]))
+                {
+                    --i;
+                    (*keys_)[out] = std::move((*keys_)[i]);
+                    (*values_)[out] = std::move((*values_)[i]);
+                }
+                else
+                {
+                    --b;
+                    (*keys_)[out] = std::move(batch[b].first);
+                    (*values_)[out] = std::move(batch[b].second);
+                }
+            }
+
+            if (!batch.empty()) layout_.invalidate();
+            return batch.size();
+        }
+
+        /*!
+        * \brief Removes key k and its value if present. Returns whether it was.
+        */
+        bool erase(const key_type& k)
+        {
+            const size_t i = find(k);
+            if (i == size()) return false;
+
+            keys_->erase(keys_->begin() + i);
+            values_->erase(values_->begin() + i);
+            layout_.invalidate();
+            return true;
+        }
+
+    private:
+        std::vector<K>* keys_;
+        std::vector<V>* values_;
+        Compare cmp_;
+        detail::eytzinger_layout<K> layout_;
+
+        void sort_entries(std::vector<std::pair<K, V> >& entries) const
+        {
+            const Compare cmp = cmp_;
+            std::stable_sort(entries.begin(), entries.end(), [cmp](const std::pair<K, V>& a, const std::pair<K, V>& b) { return cmp(a.first, b.first); });
+            entries.erase(std::unique(entries.begin(), entries.end(), [cmp](const std::pair<K, V>& a, const std::pair<K, V>& b)
+            {
+                return !cmp(a.first, b.first) && !cmp(b.first, a.first);
+            }), entries.end());
+        }
+    };
+
+    /*!
+    * \brief Returns a flat_set using the Nth container of type U in hv, which is sorted and deduplicated.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    flat_set<U> make_flat_set(vector<T, Types...>& hv)
+    {
+        return flat_set<U>(hv.template get<U, N>());
+    }
+
+    /*!
+    * \brief Returns a flat_map with keys in the container named by Key and values in the one named by Value.
+    *
+    *     auto m = heterogeneous::make_flat_map<lane<int>, lane<std::string> >(hv);
+    *
+    * Both containers are rearranged together; the other containers of hv are not touched.
+    */
+    template<typename Key, typename Value, typename T, typename... Types>
+    flat_map<typename Key::value_type, typename Value::value_type> make_flat_map(vector<T, Types...>& hv)
+    {
+        return flat_map<typename Key::value_type, typename Value::value_type>(
+            hv.template get<typename Key::value_type, Key::index>(), hv.template get<typename Value::value_type, Value::index>());
+    }
+}
+
+#endif // HETEROGENEOUS_FLAT
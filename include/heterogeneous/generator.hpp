@@ -0,0 +1,369 @@
+#ifndef HETEROGENEOUS_GENERATOR
+#define HETEROGENEOUS_GENERATOR
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file generator.hpp
+*
+* Coroutine generators streaming the elements of a heterogeneous::vector,
+* or of an adaptor, one at a time or in chunks of consecutive elements of
+* a container. Elements are produced as the consumer asks for them, in
+* place: nothing is copied or buffered.
+*
+* Requires C++20 coroutines; with older compilers or language modes this
+* header declares nothing.
+*/
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine) && defined(__cpp_lib_span)
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Lazily produced sequence of values of type T, usually references, read once from begin() to end().
+    *
+    * Each value refers to the object the coroutine yielded, which stays
+    * alive until the next value is requested.
+    */
+    template<typename T>
+    class generator
+    {
+    public:
+        // Typedefs
+        typedef std::remove_reference_t<T> value_type;
+        typedef value_type& reference;
+
+        class promise_type
+        {
+            // Friends
+            friend class generator;
+
+        public:
+            generator get_return_object() noexcept
+            {
+                return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+
+            std::suspend_always yield_value(value_type& v) noexcept
+            {
+                current_ = std::addressof(v);
+                return {};
+            }
+
+            // a temporary lives in the coroutine frame until the coroutine is resumed
+            std::suspend_always yield_value(value_type&& v) noexcept
+            {
+                current_ = std::addressof(v);
+                return {};
+            }
+
+            void return_void() const noexcept {}
+
+            void unhandled_exception() noexcept
+            {
+                error_ = std::current_exception();
+            }
+
+            // generators only yield
+            template<typename U>
+            std::suspend_never await_transform(U&&) = delete;
+
+        private:
+            value_type* current_ = nullptr;
+            std::exception_ptr error_;
+        };
+
+        /*!
+        * \brief Input iterator over the values; resuming the coroutine advances it.
+        */
+        class iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef std::ptrdiff_t difference_type;
+            typedef generator::value_type value_type;
+
+            iterator() = default;
+
+            explicit iterator(std::coroutine_handle<promise_type> coroutine) : coroutine_(coroutine)
+            {};
+
+            reference operator*() const { return *coroutine_.promise().current_; }
+            value_type* operator->() const { return coroutine_.promise().current_; }
+
+            iterator& operator++()
+            {
+                resume(coroutine_);
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            bool operator==(std::default_sentinel_t) const { return coroutine_ == nullptr || coroutine_.done(); }
+
+        private:
+            std::coroutine_handle<promise_type> coroutine_;
+        };
+
+        // Constructors & Destructors
+        generator(generator&& x) noexcept : coroutine_(std::exchange(x.coroutine_, nullptr))
+        {};
+
+        generator(const generator&) = delete;
+
+        ~generator()
+        {
+            if (coroutine_) coroutine_.destroy();
+        };
+
+        // Operators
+        generator& operator=(generator x) noexcept
+        {
+            std::swap(coroutine_, x.coroutine_);
+            return *this;
+        }
+
+        // Methods
+        /*!
+        * \brief Runs the coroutine up to its first value. Call once.
+        */
+        iterator begin()
+        {
+            resume(coroutine_);
+            return iterator(coroutine_);
+        }
+
+        std::default_sentinel_t end() const noexcept
+        {
+            return std::default_sentinel;
+        }
+
+    private:
+        std::coroutine_handle<promise_type> coroutine_;
+
+        explicit generator(std::coroutine_handle<promise_type> coroutine) : coroutine_(coroutine)
+        {};
+
+        // an exception escaping the coroutine ends it and is rethrown to the consumer
+        static void resume(std::coroutine_handle<promise_type> coroutine)
+        {
+            coroutine.resume();
+            if (coroutine.done() && coroutine.promise().error_)
+                std::rethrow_exception(std::exchange(coroutine.promise().error_, nullptr));
+        }
+    };
+
+    /*!
+    * \brief An element of a vector, of a type known only at runtime: row row of the container at position lane.
+    *
+    * The element is reached with get<U>(), or by visiting its container:
+    * hv.visit_lane(e.lane, [&](auto& C) { use(C[e.row]); }).
+    */
+    struct lane_element
+    {
+        size_t lane;
+        size_t row;
+        std::type_index type;
+        void* address;
+
+        /*!
+        * \brief Returns the element as a U. If its type is not U, throws std::invalid_argument exception.
+        */
+        template<typename U>
+        U& get() const
+        {
+            if (type != std::type_index(typeid(U)))
+                throw std::invalid_argument(std::string("Type ") + std::string(typeid(U).name()) + std::string(" is not the type of element ") + std::to_string(row) + std::string(" of container ") + std::to_string(lane) + std::string("."));
+            return *static_cast<U*>(address);
+        }
+    };
+
+    /*!
+    * \brief Elements [first, last) of the container at position lane of a vector, of a type known only at runtime.
+    */
+    struct lane_chunk
+    {
+        size_t lane;
+        size_t first;
+        size_t last;
+        std::type_index type;
+        void* data; //!< address of element first
+
+        size_t size() const { return last - first; }
+
+        /*!
+        * \brief Returns the elements as a std::span<U>. If their type is not U, throws std::invalid_argument exception.
+        */
+        template<typename U>
+        std::span<U> get() const
+        {
+            if (type != std::type_index(typeid(U)))
+                throw std::invalid_argument(std::string("Type ") + std::string(typeid(U).name()) + std::string(" is not the type of container ") + std::to_string(lane) + std::string("."));
+            return std::span<U>(static_cast<U*>(data), size());
+        }
+    };
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        // untyped view of a container, taken once per container rather than once per element
+        struct lane_span
+        {
+            std::type_index type;
+            unsigned char* data;
+            size_t size;
+            size_t stride;
+        };
+
+        template<typename V>
+        lane_span span_of(std::vector<V>& c)
+        {
+            static_assert(!std::is_same<V, bool>::value, "heterogeneous generators require addressable elements, which std::vector<bool> does not have.");
+            return lane_span{ std::type_index(typeid(V)), reinterpret_cast<unsigned char*>(c.data()), c.size(), sizeof(V) };
+        }
+
+        // data of c if its elements are U, else nullptr; possibly nullptr for an empty one too
+        template<typename U, typename V>
+        U* typed_data(std::vector<V>& c)
+        {
+            if constexpr (std::is_same<U, V>::value) return c.data();
+            else return nullptr;
+        }
+
+        template<typename U>
+        using element_t = std::conditional_t<std::is_same<U, any_type>::value, any_type, U*>;
+
+        template<typename T, typename... Types>
+        generator<lane_element> elements(vector<T, Types...>& hv, any_type)
+        {
+            for (size_t lane = 0; lane < hv.size(); ++lane)
+            {
+                const lane_span s = hv.visit_lane(lane, [](auto& C) { return span_of(C); });
+                for (size_t row = 0; row < s.size; ++row) co_yield lane_element{ lane, row, s.type, s.data + row * s.stride };
+            }
+        }
+
+        template<typename T, typename... Types, typename U>
+        generator<U&> elements(vector<T, Types...>& hv, U*)
+        {
+            static_assert(count_of<U, T, Types...>::value != 0, "heterogeneous::vector has no container with this type.");
+
+            for (size_t lane = 0; lane < hv.size(); ++lane)
+            {
+                U* data = hv.visit_lane(lane, [](auto& C) { return typed_data<U>(C); });
+                if (data == nullptr) continue;
+
+                const size_t n = hv.visit_lane(lane, [](auto& C) { return C.size(); });
+                for (size_t row = 0; row < n; ++row) co_yield data[row];
+            }
+        }
+
+        template<typename T, typename... Types>
+        generator<lane_chunk> chunks(vector<T, Types...>& hv, size_t chunk_size, any_type)
+        {
+            for (size_t lane = 0; lane < hv.size(); ++lane)
+            {
+                const lane_span s = hv.visit_lane(lane, [](auto& C) { return span_of(C); });
+                for (size_t first = 0; first < s.size; first += chunk_size)
+                {
+                    const size_t last = s.size - first < chunk_size ? s.size : first + chunk_size;
+                    co_yield lane_chunk{ lane, first, last, s.type, s.data + first * s.stride };
+                }
+            }
+        }
+
+        template<typename T, typename... Types, typename U>
+        generator<std::span<U> > chunks(vector<T, Types...>& hv, size_t chunk_size, U*)
+        {
+            static_assert(count_of<U, T, Types...>::value != 0, "heterogeneous::vector has no container with this type.");
+
+            for (size_t lane = 0; lane < hv.size(); ++lane)
+            {
+                U* data = hv.visit_lane(lane, [](auto& C) { return typed_data<U>(C); });
+                if (data == nullptr) continue;
+
+                const size_t n = hv.visit_lane(lane, [](auto& C) { return C.size(); });
+                for (size_t first = 0; first < n; first += chunk_size) co_yield std::span<U>(data + first, n - first < chunk_size ? n - first : chunk_size);
+            }
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Returns a generator of the elements of every container of hv, container by container.
+    *
+    * elements(hv) yields a lane_element per element; elements<U>(hv) yields
+    * a U& for each element of the containers of type U only. Containers
+    * must not change size while a generator iterates over them.
+    */
+    template<typename U = detail::any_type, typename T, typename... Types>
+    auto elements(vector<T, Types...>& hv)
+    {
+        return detail::elements(hv, detail::element_t<U>());
+    }
+
+    /*!
+    * \brief Returns a generator of consecutive chunks of at most chunk_size elements of every container of hv, container by container.
+    *
+    * chunks(hv, n) yields a lane_chunk per chunk; chunks<U>(hv, n) yields a
+    * std::span<U> per chunk of the containers of type U only. If
+    * chunk_size is 0, throws std::invalid_argument exception.
+    */
+    template<typename U = detail::any_type, typename T, typename... Types>
+    auto chunks(vector<T, Types...>& hv, size_t chunk_size)
+    {
+        if (chunk_size == 0)
+            throw std::invalid_argument("std::invalid_argument: chunk size must be greater than 0.");
+
+        return detail::chunks(hv, chunk_size, detail::element_t<U>());
+    }
+
+    /*!
+    * \brief Returns a generator of the elements of type native_t of a type-erased container, in order.
+    */
+    template<typename native_t, typename container_t>
+    generator<native_t&> elements(adaptor<container_t>& a)
+    {
+        for (auto itr = a.template begin<native_t>(); itr != a.template end<native_t>(); ++itr) co_yield *itr;
+    }
+}
+
+#endif // __cpp_impl_coroutine
+
+#endif // HETEROGENEOUS_GENERATOR
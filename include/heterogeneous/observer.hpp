@@ -0,0 +1,147 @@
+#ifndef HETEROGENEOUS_OBSERVER
+#define HETEROGENEOUS_OBSERVER
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file observer.hpp
+*
+* Base class for summaries which follow a single container of a
+* heterogeneous::vector and are kept up to date as elements are
+* appended to that container, and rebuilt when its rows are
+* rewritten or removed.
+*/
+
+#include <cstddef>
+#include <vector>
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Base class for per-container summaries maintained on append.
+    *
+    * Derived must provide absorb(first, last), folding the elements with
+    * indices [first, last) into the summary, and reset(), clearing it.
+    *
+    * sync() folds in every element appended since the previous call. If the
+    * container has shrunk, or the generation counter passed to watch() has
+    * advanced, the summary is rebuilt from scratch instead. Without a watched
+    * generation, elements modified in place cannot be detected; call rebuild()
+    * after doing so.
+    */
+    template<typename Derived, typename T>
+    class lane_observer
+    {
+    public:
+        // Typedefs
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+
+        /*!
+        * \brief Returns pointer to the observed container, or nullptr if detached.
+        */
+        const container_type* container() const
+        {
+            return container_;
+        }
+
+        /*!
+        * \brief Returns the number of elements folded into the summary.
+        */
+        size_t observed() const
+        {
+            return observed_;
+        }
+
+        /*!
+        * \brief Observes c, discarding the current summary.
+        */
+        void attach(const container_type& c)
+        {
+            container_ = &c;
+            generation_ = nullptr;
+            rebuild();
+        }
+
+        /*!
+        * \brief Rebuilds the summary on the next sync() whenever generation changes.
+        *
+        * generation is usually heterogeneous::vector::generation() of the vector
+        * owning the observed container, and must outlive the observer.
+        */
+        void watch(const size_t& generation)
+        {
+            generation_ = &generation;
+            seen_ = generation;
+        }
+
+        /*!
+        * \brief Stops observing the container. The summary is kept.
+        */
+        void detach()
+        {
+            container_ = nullptr;
+            generation_ = nullptr;
+        }
+
+        /*!
+        * \brief Folds elements appended since the last call into the summary.
+        */
+        void sync()
+        {
+            if (container_ == nullptr) return;
+
+            const size_t n = container_->size();
+            if (n < observed_ || (generation_ != nullptr && *generation_ != seen_))
+            {
+                rebuild();
+                return;
+            }
+            if (n == observed_) return;
+
+            derived().absorb(observed_, n);
+            observed_ = n;
+        }
+
+        /*!
+        * \brief Recomputes the summary from every element of the container.
+        */
+        void rebuild()
+        {
+            derived().reset();
+            observed_ = 0;
+            if (generation_ != nullptr) seen_ = *generation_;
+            sync();
+        }
+
+    protected:
+        // Constructors & Destructors
+        lane_observer() : container_(nullptr), observed_(0), generation_(nullptr), seen_(0)
+        {};
+
+        explicit lane_observer(const container_type& c) : container_(&c), observed_(0), generation_(nullptr), seen_(0)
+        {};
+
+        ~lane_observer()
+        {};
+
+    private:
+        const container_type* container_;
+        size_t observed_;
+        const size_t* generation_;
+        size_t seen_;
+
+        Derived& derived()
+        {
+            return *static_cast<Derived*>(this);
+        }
+    };
+}
+
+#endif // HETEROGENEOUS_OBSERVER
@@ -0,0 +1,461 @@
+#ifndef HETEROGENEOUS_PARALLEL
+#define HETEROGENEOUS_PARALLEL
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file parallel.hpp
+*
+* Execution policies and the threading primitives shared by the
+* parallel algorithms of the extension headers: a pool of threads,
+* started once, which balances the ranges of each parallel loop across
+* threads by work stealing.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Policy selecting the single threaded overload of an algorithm.
+    */
+    struct sequential_policy
+    {};
+
+    /*!
+    * \brief Policy selecting the multithreaded overload of an algorithm.
+    */
+    struct parallel_policy
+    {};
+
+    const sequential_policy seq = sequential_policy();
+    const parallel_policy par = parallel_policy();
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        /*!
+        * \brief Returns the number of threads parallel algorithms use.
+        */
+        inline size_t concurrency()
+        {
+            const size_t n = std::thread::hardware_concurrency();
+            return n == 0 ? 1 : n;
+        }
+
+        /*!
+        * \brief A range of indices left to process, owned by one participant of a range_job.
+        *
+        * The owner takes chunks from the front; other participants steal
+        * from the back. Padded so that slots of different participants do
+        * not share a cache line.
+        */
+        struct range_slot
+        {
+            std::mutex mutex;
+            std::atomic<size_t> first;
+            std::atomic<size_t> last;
+            char padding[64];
+
+            range_slot() : first(0), last(0)
+            {};
+        };
+
+        /*!
+        * \brief Calls of fn(first, last) over disjoint ranges covering [0, n), shared by the threads of a scheduler.
+        *
+        * [0, n) starts evenly split among the slots, one per participant.
+        * A participant takes adaptively sized chunks from the front of its
+        * own range, large while much of it is left and down to grain
+        * indices near its end; once its range is empty, it steals the back
+        * half of the largest range left. Threads which are busy elsewhere
+        * thus only delay the work they have already taken.
+        */
+        class range_job
+        {
+        public:
+            // Constructors & Destructors
+            range_job(size_t n, size_t grain, size_t slots, std::function<void(size_t, size_t)> fn) : slots_(new range_slot[slots]), count_(slots), grain_(grain), fn_(std::move(fn)), next_(0), active_(0), failed_(false)
+            {
+                for (size_t s = 0; s < slots; ++s)
+                {
+                    slots_[s].first = n * s / slots;
+                    slots_[s].last = n * (s + 1) / slots;
+                }
+            };
+
+            // Methods
+            /*!
+            * \brief Returns whether another participant may join, that is whether a slot is free and work is left.
+            */
+            bool joinable() const
+            {
+                return next_.load() < count_ && !failed_.load() && left() != 0;
+            }
+
+            /*!
+            * \brief Reserves a slot for the calling thread. Returns its position.
+            */
+            size_t join()
+            {
+                ++active_;
+                return next_++;
+            }
+
+            /*!
+            * \brief Processes chunks from slot self, then stolen ones, until no work is left, then leaves the job.
+            */
+            void participate(size_t self)
+            {
+                size_t first, last;
+                while (!failed_.load() && take(self, first, last))
+                {
+                    try
+                    {
+                        fn_(first, last);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if (!error_) error_ = std::current_exception();
+                        failed_ = true;
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--active_ == 0) idle_.notify_all();
+            }
+
+            /*!
+            * \brief Waits until every participant has left, then rethrows the first exception thrown by fn, if any.
+            */
+            void wait()
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                idle_.wait(lock, [this]() { return active_.load() == 0; });
+
+                if (error_) std::rethrow_exception(error_);
+            }
+
+        private:
+            std::unique_ptr<range_slot[]> slots_;
+            size_t count_;
+            size_t grain_;
+            std::function<void(size_t, size_t)> fn_;
+            std::atomic<size_t> next_;
+            std::atomic<size_t> active_;
+            std::atomic<bool> failed_;
+            std::exception_ptr error_;
+            std::mutex mutex_;
+            std::condition_variable idle_;
+
+            static size_t remaining(const range_slot& s)
+            {
+                const size_t first = s.first.load(), last = s.last.load();
+                return last > first ? last - first : 0;
+            }
+
+            // approximate, as slots change concurrently
+            size_t left() const
+            {
+                size_t result = 0;
+                for (size_t s = 0; s < count_; ++s) result += remaining(slots_[s]);
+                return result;
+            }
+
+            bool take(size_t self, size_t& first, size_t& last)
+            {
+                range_slot& own = slots_[self];
+                for (;;)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(own.mutex);
+                        const size_t n = remaining(own);
+                        if (n != 0)
+                        {
+                            // guided: a fraction of what is left, so chunks shrink as the range runs out
+                            const size_t chunk = std::min(n, std::max(grain_, n / 4));
+                            first = own.first.load();
+                            last = first + chunk;
+                            own.first = last;
+                            return true;
+                        }
+                    }
+
+                    if (!steal(self)) return false;
+                }
+            }
+
+            bool steal(size_t self)
+            {
+                for (;;)
+                {
+                    size_t victim = count_, largest = 0;
+                    for (size_t s = 0; s < count_; ++s)
+                    {
+                        const size_t n = remaining(slots_[s]);
+                        if (s != self && n > largest)
+                        {
+                            victim = s;
+                            largest = n;
+                        }
+                    }
+                    if (victim == count_) return false;
+
+                    size_t first, last;
+                    {
+                        std::lock_guard<std::mutex> lock(slots_[victim].mutex);
+                        const size_t n = remaining(slots_[victim]);
+                        if (n == 0) continue;
+
+                        // a range too small to share is taken whole
+                        last = slots_[victim].last.load();
+                        first = n < 2 * grain_ ? slots_[victim].first.load() : last - n / 2;
+                        slots_[victim].last = first;
+                    }
+
+                    std::lock_guard<std::mutex> lock(slots_[self].mutex);
+                    slots_[self].first = first;
+                    slots_[self].last = last;
+                    return true;
+                }
+            }
+        };
+
+        /*!
+        * \brief Pool of concurrency() - 1 threads running range_jobs together with the threads which submit them.
+        *
+        * Threads are started on first use and reused by every parallel
+        * algorithm. Jobs may be submitted from several threads at once and
+        * from within a running job: the submitting thread always works on
+        * its own job, so nested jobs cannot deadlock.
+        */
+        class scheduler
+        {
+        public:
+            // Constructors & Destructors
+            scheduler() : stop_(false)
+            {
+                const size_t threads = concurrency() - 1;
+                for (size_t t = 0; t < threads; ++t) threads_.emplace_back([this]() { work(); });
+            };
+
+            ~scheduler()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stop_ = true;
+                }
+                wake_.notify_all();
+                for (auto& t : threads_) t.join();
+            };
+
+            scheduler(const scheduler&) = delete;
+            scheduler& operator=(const scheduler&) = delete;
+
+            // Methods
+            static scheduler& instance()
+            {
+                static scheduler s;
+                return s;
+            }
+
+            /*!
+            * \brief Runs job on the calling thread and on the idle threads of the pool; returns once it is done.
+            */
+            void run(range_job& job)
+            {
+                const size_t self = job.join();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    jobs_.push_back(&job);
+                }
+                wake_.notify_all();
+
+                job.participate(self);
+
+                // once withdrawn no thread joins, so the job only waits for chunks already taken
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+                }
+                job.wait();
+            }
+
+        private:
+            std::vector<std::thread> threads_;
+            std::vector<range_job*> jobs_;
+            std::mutex mutex_;
+            std::condition_variable wake_;
+            bool stop_;
+
+            void work()
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                for (;;)
+                {
+                    range_job* job = nullptr;
+                    wake_.wait(lock, [this, &job]()
+                    {
+                        for (range_job* j : jobs_)
+                        {
+                            if (j->joinable())
+                            {
+                                job = j;
+                                return true;
+                            }
+                        }
+                        return stop_;
+                    });
+                    if (job == nullptr) return;
+
+                    // joined under the lock, so run() cannot withdraw the job in between
+                    const size_t self = job->join();
+                    lock.unlock();
+                    job->participate(self);
+                    lock.lock();
+                }
+            }
+        };
+
+        /*!
+        * \brief Calls fn(first, last) over disjoint ranges covering [0, n).
+        *
+        * Ranges hold at least grain indices, except possibly the last ones of
+        * a thread. They are balanced across the threads of the scheduler by
+        * work stealing, the calling thread taking part. The first exception
+        * thrown by fn is rethrown once every range started has finished;
+        * ranges not yet started are skipped.
+        */
+        template<typename Function>
+        void parallel_for(size_t n, size_t grain, Function fn)
+        {
+            if (grain == 0) grain = 1;
+
+            size_t slots = (n + grain - 1) / grain;
+            if (slots > concurrency()) slots = concurrency();
+            if (slots <= 1)
+            {
+                if (n > 0) fn(size_t(0), n);
+                return;
+            }
+
+            range_job job(n, grain, slots, std::ref(fn));
+            scheduler::instance().run(job);
+        }
+
+        /*!
+        * \brief Calls fn(piece, first, last) over disjoint ranges covering [0, sizes[piece]) for every piece.
+        *
+        * Pieces, e.g. the containers of a vector, are laid end to end and
+        * split like the indices of parallel_for(), so that a large piece is
+        * shared by several threads rather than left to one. A piece for which
+        * whole[piece] is true is never split: fn(piece, 0, sizes[piece]) is
+        * called once, sizes[piece] only weighing it against the others.
+        */
+        template<typename Function>
+        void parallel_for_pieces(const std::vector<size_t>& sizes, const std::vector<bool>& whole, size_t grain, Function fn)
+        {
+            std::vector<size_t> offsets(sizes.size() + 1, 0);
+            for (size_t p = 0; p < sizes.size(); ++p) offsets[p + 1] = offsets[p] + sizes[p];
+
+            parallel_for(offsets.back(), grain, [&](size_t first, size_t last)
+            {
+                size_t p = std::upper_bound(offsets.begin(), offsets.end(), first) - offsets.begin() - 1;
+                for (; p < sizes.size() && offsets[p] < last; ++p)
+                {
+                    if (sizes[p] == 0) continue;
+                    if (whole[p])
+                    {
+                        // run by the range holding its first index
+                        if (offsets[p] >= first) fn(p, size_t(0), sizes[p]);
+                    }
+                    else
+                    {
+                        fn(p, std::max(first, offsets[p]) - offsets[p], std::min(last, offsets[p + 1]) - offsets[p]);
+                    }
+                }
+            });
+        }
+
+        /*!
+        * \brief Runs every task, concurrently when there is more than one.
+        */
+        inline void parallel_invoke(const std::vector<std::function<void()> >& tasks)
+        {
+            parallel_for(tasks.size(), 1, [&tasks](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; ++i) tasks[i]();
+            });
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Calls fn(container, first, last) for each container of hv holding elements, with first = 0 and last its size.
+    */
+    template<typename T, typename... Types, typename Function>
+    void for_each_chunk(vector<T, Types...>& hv, Function fn)
+    {
+        hv.for_each([&fn](auto& C)
+        {
+            if (!C.empty()) fn(C, size_t(0), C.size());
+        });
+    }
+
+    /*!
+    * \brief Same as for_each_chunk() but calls fn concurrently on disjoint ranges [first, last) of the containers.
+    *
+    * Containers are split into ranges of at least grain elements, balanced
+    * across threads by work stealing, so that one container much larger
+    * than the others keeps every thread busy. fn must be safe to call from
+    * several threads at once, on different ranges of the same container
+    * too; each element is covered by exactly one call.
+    */
+    template<typename T, typename... Types, typename Function>
+    void for_each_chunk(vector<T, Types...>& hv, parallel_policy, Function fn, size_t grain = size_t(1) << 14)
+    {
+        std::vector<size_t> sizes;
+        std::vector<std::function<void(size_t, size_t)> > calls;
+        hv.for_each([&sizes, &calls, &fn](auto& C)
+        {
+            sizes.push_back(C.size());
+            calls.push_back([&C, &fn](size_t first, size_t last) { fn(C, first, last); });
+        });
+
+        detail::parallel_for_pieces(sizes, std::vector<bool>(sizes.size(), false), grain, [&calls](size_t lane, size_t first, size_t last)
+        {
+            calls[lane](first, last);
+        });
+    }
+
+    template<typename T, typename... Types, typename Function>
+    void for_each_chunk(vector<T, Types...>& hv, sequential_policy, Function fn)
+    {
+        for_each_chunk(hv, fn);
+    }
+}
+
+#endif // HETEROGENEOUS_PARALLEL
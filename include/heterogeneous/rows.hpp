@@ -0,0 +1,654 @@
+#ifndef HETEROGENEOUS_ROWS
+#define HETEROGENEOUS_ROWS
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file rows.hpp
+*
+* Row-wise operations on a heterogeneous::vector whose containers all
+* hold the same number of elements, element i of every container making
+* up row i.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#endif
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Names the Nth container of type U, for algorithms working on a chosen set of containers.
+    */
+    template<typename U, size_t N = 0>
+    struct lane
+    {
+        typedef U value_type;
+        static const size_t index = N;
+    };
+
+    /*!
+    * \brief Returns the number of rows of hv.
+    *
+    * If the containers of hv hold different numbers of elements, throws
+    * std::invalid_argument exception.
+    */
+    template<typename T, typename... Types>
+    size_t rows(vector<T, Types...>& hv)
+    {
+        const size_t n = hv.template get<T, 0>().size();
+        if (!hv.all_of([n](const auto& C) { return C.size() == n; }))
+            throw std::invalid_argument("std::invalid_argument: Containers of heterogeneous::vector hold different numbers of elements.");
+
+        return n;
+    }
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        // rows this far ahead of the one being copied are prefetched
+        const size_t prefetch_distance = 16;
+
+        inline void prefetch(const void* p)
+        {
+#if defined(__AVX2__) || defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+            _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+            (void)p;
+#endif
+        }
+
+        template<typename C>
+        void prefetch(const C& c, size_t i)
+        {
+            prefetch(&c[i]);
+        }
+
+        inline void prefetch(const std::vector<bool>&, size_t)
+        {}
+
+        /*!
+        * \brief True for element types which can be moved around as plain 4 or 8 byte words.
+        */
+        template<typename T>
+        struct is_word_sized : std::integral_constant<bool,
+            std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value && (sizeof(T) == 4 || sizeof(T) == 8)>
+        {};
+
+        /*!
+        * \brief Throws std::out_of_range if any index is not below n.
+        */
+        inline void check_indices(const std::vector<size_t>& indices, size_t n)
+        {
+            size_t largest = 0;
+            for (size_t i = 0; i < indices.size(); ++i) largest = indices[i] > largest ? indices[i] : largest;
+
+            if (!indices.empty() && largest >= n)
+                throw std::out_of_range(std::string("std::out_of_range: Row index ") + std::to_string(largest) + std::string(" does not exist in heterogeneous::vector with ") + std::to_string(n) + std::string(" rows."));
+        }
+
+        /*!
+        * \brief out[i] = src[idx[i]] for i in [0, n), out holding n elements.
+        */
+        template<typename T>
+        void gather(const T* src, const size_t* idx, size_t n, T* out, std::true_type /*gatherable*/)
+        {
+            size_t i = 0;
+#if defined(__AVX2__)
+            for (; i + 4 <= n; i += 4)
+            {
+                if (i + prefetch_distance < n) prefetch(src + idx[i + prefetch_distance]);
+
+                const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+                if (sizeof(T) == 8)
+                {
+                    const __m256i v = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(src), index, 8);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+                }
+                else
+                {
+                    const __m128i v = _mm256_i64gather_epi32(reinterpret_cast<const int*>(src), index, 4);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+                }
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                if (i + prefetch_distance < n) prefetch(src + idx[i + prefetch_distance]);
+                out[i] = src[idx[i]];
+            }
+        }
+
+        template<typename C>
+        void gather(const C& src, const std::vector<size_t>& idx, C& out, std::true_type)
+        {
+            out.resize(idx.size());
+            gather(src.data(), idx.data(), idx.size(), out.data(), std::true_type());
+        }
+
+        template<typename C>
+        void gather(const C& src, const std::vector<size_t>& idx, C& out, std::false_type)
+        {
+            const size_t n = idx.size();
+
+            // assign over existing elements so their capacity (e.g. strings) is reused
+            const size_t kept = std::min(out.size(), n);
+            for (size_t i = 0; i < kept; ++i)
+            {
+                if (i + prefetch_distance < n) prefetch(src, idx[i + prefetch_distance]);
+                out[i] = src[idx[i]];
+            }
+
+            out.resize(kept);
+            for (size_t i = kept; i < n; ++i)
+            {
+                if (i + prefetch_distance < n) prefetch(src, idx[i + prefetch_distance]);
+                out.push_back(src[idx[i]]);
+            }
+        }
+
+        template<typename C>
+        void gather(const C& src, const std::vector<size_t>& idx, C& out)
+        {
+            gather(src, idx, out, is_word_sized<typename C::value_type>());
+        }
+
+        /*!
+        * \brief dst[idx[i]] = src[i] for each i.
+        */
+        template<typename C>
+        void scatter(const C& src, const std::vector<size_t>& idx, C& dst)
+        {
+            const size_t n = idx.size();
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (i + prefetch_distance < n) prefetch(dst, idx[i + prefetch_distance]);
+                dst[idx[i]] = src[i];
+            }
+        }
+
+        template<typename C>
+        void reorder(C& c, const std::vector<size_t>& order, std::true_type /*gatherable*/)
+        {
+            C temp;
+            gather(c, order, temp, std::true_type());
+            c.swap(temp);
+        }
+
+        template<typename C>
+        void reorder(C& c, const std::vector<size_t>& order, std::false_type)
+        {
+            // order is a permutation, so every element is moved from exactly once
+            C temp;
+            temp.reserve(order.size());
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                if (i + prefetch_distance < order.size()) prefetch(c, order[i + prefetch_distance]);
+                temp.push_back(std::move(c[order[i]]));
+            }
+            c.swap(temp);
+        }
+
+        template<typename C>
+        void reorder(C& c, const std::vector<size_t>& order)
+        {
+            reorder(c, order, is_word_sized<typename C::value_type>());
+        }
+
+#if defined(__AVX2__)
+        /*!
+        * \brief Permutations moving the words selected by an 8 bit mask to the front.
+        *
+        * Entry m holds 8 indices for _mm256_permutevar8x32_epi32, followed by
+        * the number of selected elements. With Wide, mask bits select pairs of
+        * 32-bit words (4 bit masks, 64-bit elements).
+        */
+        template<bool Wide>
+        const std::uint32_t* compress_table()
+        {
+            static const std::vector<std::uint32_t> table = []()
+            {
+                const size_t masks = Wide ? 16 : 256;
+                std::vector<std::uint32_t> t(masks * 9, 0);
+                for (size_t m = 0; m < masks; ++m)
+                {
+                    std::uint32_t k = 0;
+                    for (std::uint32_t b = 0; b < (Wide ? 4u : 8u); ++b)
+                    {
+                        if (!((m >> b) & 1)) continue;
+                        if (Wide)
+                        {
+                            t[m * 9 + 2 * k] = 2 * b;
+                            t[m * 9 + 2 * k + 1] = 2 * b + 1;
+                        }
+                        else
+                        {
+                            t[m * 9 + k] = b;
+                        }
+                        ++k;
+                    }
+                    t[m * 9 + 8] = k;
+                }
+                return t;
+            }();
+
+            return table.data();
+        }
+#endif
+
+        /*!
+        * \brief Moves data[i] for which keep[i] != 0 to the front, in order. Returns their number.
+        */
+        template<typename T>
+        size_t compress(T* data, const std::uint8_t* keep, size_t n, std::true_type /*word sized*/)
+        {
+            size_t i = 0, j = 0;
+#if defined(__AVX2__)
+            // each step loads 32 bytes before storing at j <= i, so compressing in place is safe
+            const size_t step = 32 / sizeof(T);
+            const std::uint32_t* table = compress_table<sizeof(T) == 8>();
+
+            for (; i + step <= n; i += step)
+            {
+                // load only the step flags of this block, which for 8 byte elements are 4
+                std::uint64_t bytes = 0;
+                std::memcpy(&bytes, keep + i, step);
+                const __m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&bytes));
+                // a flag keeps its element when nonzero, as below; comparing signed bytes > 0 would drop 0x80 to 0xff
+                const unsigned m = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(flags, _mm_setzero_si128()))) & ((1u << step) - 1);
+
+                const std::uint32_t* entry = table + m * 9;
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                const __m256i permutation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entry));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + j), _mm256_permutevar8x32_epi32(v, permutation));
+                j += entry[8];
+            }
+#endif
+            // branchless: always write, only advance past kept elements
+            for (; i < n; ++i)
+            {
+                data[j] = data[i];
+                j += keep[i] != 0;
+            }
+
+            return j;
+        }
+
+        template<typename C>
+        void compact(C& c, const std::vector<std::uint8_t>& keep, std::true_type)
+        {
+            c.resize(compress(c.data(), keep.data(), c.size(), std::true_type()));
+        }
+
+        template<typename C>
+        void compact(C& c, const std::vector<std::uint8_t>& keep, std::false_type)
+        {
+            size_t j = 0;
+            for (size_t i = 0; i < c.size(); ++i)
+            {
+                if (!keep[i]) continue;
+                if (j != i) c[j] = std::move(c[i]);
+                ++j;
+            }
+
+            c.erase(c.begin() + j, c.end());
+        }
+
+        template<typename C>
+        void compact(C& c, const std::vector<std::uint8_t>& keep)
+        {
+            compact(c, keep, is_word_sized<typename C::value_type>());
+        }
+
+        /*!
+        * \brief Runs fn(container, x_container) for each pair of corresponding containers as concurrent tasks.
+        */
+        template<typename T, typename... Types, typename Function>
+        void parallel_for_each(vector<T, Types...>& hv, vector<T, Types...>& x, Function fn)
+        {
+            std::vector<std::function<void()> > tasks;
+            hv.for_each(x, [&tasks, &fn](auto& C, auto& X)
+            {
+                tasks.push_back([&C, &X, &fn]() { fn(C, X); });
+            });
+
+            parallel_invoke(tasks);
+        }
+
+        /*!
+        * \brief Work over the containers of a vector, run by parallel_for_pieces().
+        *
+        * A piece added with split = true may be processed as several ranges
+        * concurrently, the others are processed whole. Each finishing step
+        * runs once every piece is done, on the calling thread.
+        */
+        class lane_pieces
+        {
+        public:
+            // Constructors & Destructors
+            explicit lane_pieces(size_t grain) : grain_(grain)
+            {};
+
+            // Methods
+            template<typename Function>
+            void add(size_t size, bool split, Function fn)
+            {
+                // nothing to share out, but e.g. an empty gather still resizes its output
+                if (size == 0) return fn(size_t(0), size_t(0));
+
+                sizes_.push_back(size);
+                whole_.push_back(!split);
+                calls_.push_back(fn);
+            }
+
+            template<typename Function>
+            void finish(Function fn)
+            {
+                finish_.push_back(fn);
+            }
+
+            void run()
+            {
+                parallel_for_pieces(sizes_, whole_, grain_, [this](size_t piece, size_t first, size_t last)
+                {
+                    calls_[piece](first, last);
+                });
+
+                for (auto& fn : finish_) fn();
+            }
+
+        private:
+            size_t grain_;
+            std::vector<size_t> sizes_;
+            std::vector<bool> whole_;
+            std::vector<std::function<void(size_t, size_t)> > calls_;
+            std::vector<std::function<void()> > finish_;
+        };
+
+        // rows per range when containers are split across threads
+        const size_t rows_grain = size_t(1) << 14;
+
+        template<typename C>
+        void add_gather(lane_pieces& pieces, const C& src, const std::vector<size_t>& idx, C& out, std::true_type /*gatherable*/)
+        {
+            out.resize(idx.size());
+            pieces.add(idx.size(), true, [&src, &idx, &out](size_t first, size_t last)
+            {
+                gather(src.data(), idx.data() + first, last - first, out.data() + first, std::true_type());
+            });
+        }
+
+        template<typename C>
+        void add_gather(lane_pieces& pieces, const C& src, const std::vector<size_t>& idx, C& out, std::false_type)
+        {
+            pieces.add(idx.size(), false, [&src, &idx, &out](size_t, size_t) { gather(src, idx, out, std::false_type()); });
+        }
+
+        template<typename T, typename... Types>
+        void gather(vector<T, Types...>& hv, const std::vector<size_t>& indices, vector<T, Types...>& dst, sequential_policy)
+        {
+            hv.for_each(dst, [&indices](auto& C, auto& D) { gather(C, indices, D); });
+        }
+
+        template<typename T, typename... Types>
+        void gather(vector<T, Types...>& hv, const std::vector<size_t>& indices, vector<T, Types...>& dst, parallel_policy)
+        {
+            lane_pieces pieces(rows_grain);
+            hv.for_each(dst, [&pieces, &indices](auto& C, auto& D)
+            {
+                add_gather(pieces, C, indices, D, is_word_sized<typename std::decay_t<decltype(C)>::value_type>());
+            });
+            pieces.run();
+        }
+
+        template<typename C>
+        void add_reorder(lane_pieces& pieces, C& c, const std::vector<size_t>& order, std::true_type /*gatherable*/)
+        {
+            std::shared_ptr<C> temp = std::make_shared<C>(order.size());
+            pieces.add(order.size(), true, [&c, &order, temp](size_t first, size_t last)
+            {
+                gather(c.data(), order.data() + first, last - first, temp->data() + first, std::true_type());
+            });
+            pieces.finish([&c, temp]() { c.swap(*temp); });
+        }
+
+        template<typename C>
+        void add_reorder(lane_pieces& pieces, C& c, const std::vector<size_t>& order, std::false_type)
+        {
+            pieces.add(order.size(), false, [&c, &order](size_t, size_t) { reorder(c, order, std::false_type()); });
+        }
+
+        template<typename T, typename... Types>
+        void reorder(vector<T, Types...>& hv, const std::vector<size_t>& order, sequential_policy)
+        {
+            hv.for_each([&order](auto& C) { reorder(C, order); });
+        }
+
+        template<typename T, typename... Types>
+        void reorder(vector<T, Types...>& hv, const std::vector<size_t>& order, parallel_policy)
+        {
+            lane_pieces pieces(rows_grain);
+            hv.for_each([&pieces, &order](auto& C)
+            {
+                add_reorder(pieces, C, order, is_word_sized<typename std::decay_t<decltype(C)>::value_type>());
+            });
+            pieces.run();
+        }
+
+        /*!
+        * \brief Kept rows of a mask counted per block of rows_grain rows: block b moves to offsets[b].
+        */
+        inline std::vector<size_t> block_offsets(const std::vector<std::uint8_t>& keep)
+        {
+            const size_t blocks = (keep.size() + rows_grain - 1) / rows_grain;
+
+            std::vector<size_t> offsets(blocks + 1, 0);
+            parallel_for(blocks, 1, [&keep, &offsets](size_t first, size_t last)
+            {
+                for (size_t b = first; b < last; ++b)
+                {
+                    const size_t end = std::min(keep.size(), (b + 1) * rows_grain);
+                    size_t kept = 0;
+                    for (size_t i = b * rows_grain; i < end; ++i) kept += keep[i] != 0;
+                    offsets[b + 1] = kept;
+                }
+            });
+
+            for (size_t b = 0; b < blocks; ++b) offsets[b + 1] += offsets[b];
+            return offsets;
+        }
+
+        template<typename C>
+        void add_compact(lane_pieces& pieces, C& c, const std::vector<std::uint8_t>& keep, const std::vector<size_t>& offsets, std::true_type /*word sized*/)
+        {
+            std::shared_ptr<C> temp = std::make_shared<C>(offsets.back());
+            pieces.add(offsets.size() - 1, true, [&c, &keep, &offsets, temp](size_t first, size_t last)
+            {
+                for (size_t b = first; b < last; ++b)
+                {
+                    // compressing the block in place first keeps the copy branch free; c is discarded afterwards
+                    const size_t begin = b * rows_grain;
+                    const size_t kept = compress(c.data() + begin, keep.data() + begin, std::min(c.size(), begin + rows_grain) - begin, std::true_type());
+                    std::copy(c.data() + begin, c.data() + begin + kept, temp->data() + offsets[b]);
+                }
+            });
+            pieces.finish([&c, temp]() { c.swap(*temp); });
+        }
+
+        template<typename C>
+        void add_compact(lane_pieces& pieces, C& c, const std::vector<std::uint8_t>& keep, const std::vector<size_t>&, std::false_type)
+        {
+            pieces.add((keep.size() + rows_grain - 1) / rows_grain, false, [&c, &keep](size_t, size_t) { compact(c, keep, std::false_type()); });
+        }
+
+        template<typename T, typename... Types>
+        void compact(vector<T, Types...>& hv, const std::vector<std::uint8_t>& keep, sequential_policy)
+        {
+            hv.for_each([&keep](auto& C) { compact(C, keep); });
+        }
+
+        template<typename T, typename... Types>
+        void compact(vector<T, Types...>& hv, const std::vector<std::uint8_t>& keep, parallel_policy)
+        {
+            const std::vector<size_t> offsets = block_offsets(keep);
+
+            // pieces count blocks of rows here
+            lane_pieces pieces(1);
+            hv.for_each([&pieces, &keep, &offsets](auto& C)
+            {
+                add_compact(pieces, C, keep, offsets, is_word_sized<typename std::decay_t<decltype(C)>::value_type>());
+            });
+            pieces.run();
+        }
+
+        template<typename T, typename... Types, typename Function>
+        void for_each(vector<T, Types...>& hv, vector<T, Types...>& x, Function fn, sequential_policy)
+        {
+            hv.for_each(x, fn);
+        }
+
+        template<typename T, typename... Types, typename Function>
+        void for_each(vector<T, Types...>& hv, vector<T, Types...>& x, Function fn, parallel_policy)
+        {
+            parallel_for_each(hv, x, fn);
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief Rearranges every container of hv so that row i becomes former row order[i].
+    *
+    * order must be a permutation of the row indices of hv. With par,
+    * containers of 4 or 8 byte trivially copyable elements are split into
+    * ranges of rows shared among threads, the others are reordered whole,
+    * concurrently. Advances hv.generation().
+    */
+    template<typename T, typename... Types, typename Policy = sequential_policy>
+    void reorder_rows(vector<T, Types...>& hv, const std::vector<size_t>& order, Policy policy = Policy())
+    {
+        if (order.size() != rows(hv))
+            throw std::invalid_argument("std::invalid_argument: Row order does not match the number of rows of heterogeneous::vector.");
+
+        detail::reorder(hv, order, policy);
+        hv.touch();
+    }
+
+    /*!
+    * \brief Makes row i of dst a copy of row indices[i] of hv, for each i.
+    *
+    * The containers of dst are resized to indices.size(), reusing their
+    * capacity. Random indices are prefetched ahead of use, and containers of
+    * 4 or 8 byte trivially copyable elements are gathered with AVX2 when
+    * available. With par, containers are gathered concurrently, those of 4
+    * or 8 byte elements split into ranges of rows so that large ones are
+    * shared among threads. Advances dst.generation().
+    *
+    * If any index is not a row of hv, throws std::out_of_range exception.
+    */
+    template<typename T, typename... Types, typename Policy = sequential_policy>
+    void gather_into(vector<T, Types...>& hv, const std::vector<size_t>& indices, vector<T, Types...>& dst, Policy policy = Policy())
+    {
+        detail::check_indices(indices, rows(hv));
+        detail::gather(hv, indices, dst, policy);
+        dst.touch();
+    }
+
+    /*!
+    * \brief Returns a new vector holding copies of rows indices[0], indices[1], ... of hv.
+    *
+    * See gather_into().
+    */
+    template<typename T, typename... Types, typename Policy = sequential_policy>
+    vector<T, Types...> take(vector<T, Types...>& hv, const std::vector<size_t>& indices, Policy policy = Policy())
+    {
+        vector<T, Types...> result;
+        gather_into(hv, indices, result, policy);
+        return result;
+    }
+
+    /*!
+    * \brief Overwrites row indices[i] of hv with row i of src, for each i.
+    *
+    * src must hold indices.size() rows. If an index appears more than once,
+    * the last of its source rows is kept. Advances hv.generation().
+    *
+    * If any index is not a row of hv, throws std::out_of_range exception.
+    */
+    template<typename T, typename... Types, typename Policy = sequential_policy>
+    void scatter(vector<T, Types...>& hv, const std::vector<size_t>& indices, vector<T, Types...>& src, Policy policy = Policy())
+    {
+        if (rows(src) != indices.size())
+            throw std::invalid_argument("std::invalid_argument: Number of source rows does not match the number of row indices.");
+        detail::check_indices(indices, rows(hv));
+
+        detail::for_each(hv, src, [&indices](auto& C, auto& S) { detail::scatter(S, indices, C); }, policy);
+        hv.touch();
+    }
+
+    /*!
+    * \brief Removes every row i of hv for which keep[i] is 0, keeping the others in order.
+    *
+    * keep must hold one flag per row. Containers are compacted in a single
+    * pass each, with AVX2 for containers of 4 or 8 byte trivially copyable
+    * elements when available; with par, concurrently, those of 4 or 8 byte
+    * elements split into blocks of rows so that large ones are shared among
+    * threads. Advances hv.generation() and returns the number of rows left.
+    */
+    template<typename T, typename... Types, typename Policy = sequential_policy>
+    size_t keep_rows(vector<T, Types...>& hv, const std::vector<std::uint8_t>& keep, Policy policy = Policy())
+    {
+        if (keep.size() != rows(hv))
+            throw std::invalid_argument("std::invalid_argument: Row mask does not match the number of rows of heterogeneous::vector.");
+
+        detail::compact(hv, keep, policy);
+        hv.touch();
+        return hv.template get<T, 0>().size();
+    }
+
+    /*!
+    * \brief Removes every row of hv whose element of the Nth container of type U satisfies pred.
+    *
+    * pred is evaluated once per row, then every container is compacted as by
+    * keep_rows(). Returns the number of rows removed.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Pred, typename Policy = sequential_policy>
+    size_t erase_rows_if(vector<T, Types...>& hv, Pred pred, Policy policy = Policy())
+    {
+        const std::vector<U>& c = hv.template get<U, N>();
+
+        std::vector<std::uint8_t> keep(c.size());
+        for (size_t i = 0; i < c.size(); ++i) keep[i] = pred(c[i]) ? 0 : 1;
+
+        const size_t before = c.size();
+        return before - keep_rows(hv, keep, policy);
+    }
+}
+
+#endif // HETEROGENEOUS_ROWS
@@ -0,0 +1,272 @@
+#ifndef HETEROGENEOUS_SAMPLE
+#define HETEROGENEOUS_SAMPLE
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file sample.hpp
+*
+* Random samples of the rows of a heterogeneous::vector: a fixed number
+* of rows without replacement, each row independently with a fixed
+* probability, and a reservoir keeping a uniform sample of a vector as
+* rows are appended to it.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "rows.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        /*!
+        * \brief Returns a uniform double within (0, 1), never 0 so that its logarithm is finite.
+        */
+        template<typename URBG>
+        double open_unit(URBG& rng)
+        {
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            double u = unit(rng);
+            while (u <= 0.0) u = unit(rng);
+            return u;
+        }
+
+        /*!
+        * \brief Returns k distinct uniformly chosen integers of [0, n), in ascending order.
+        *
+        * Floyd's algorithm draws exactly k random numbers. Membership is kept
+        * in a hash set when k is small relative to n, in a byte per candidate
+        * otherwise.
+        */
+        template<typename URBG>
+        std::vector<size_t> sample_indices(size_t n, size_t k, URBG& rng)
+        {
+            std::vector<size_t> result;
+            if (k > n) k = n;
+            result.reserve(k);
+
+            if (k < n / 8)
+            {
+                std::unordered_set<size_t> chosen(2 * k);
+                for (size_t j = n - k; j < n; ++j)
+                {
+                    const size_t t = std::uniform_int_distribution<size_t>(0, j)(rng);
+                    const size_t pick = chosen.insert(t).second ? t : j;
+                    if (pick == j) chosen.insert(j);
+                    result.push_back(pick);
+                }
+                std::sort(result.begin(), result.end());
+            }
+            else
+            {
+                std::vector<std::uint8_t> chosen(n, 0);
+                for (size_t j = n - k; j < n; ++j)
+                {
+                    const size_t t = std::uniform_int_distribution<size_t>(0, j)(rng);
+                    chosen[chosen[t] == 0 ? t : j] = 1;
+                }
+                for (size_t i = 0; i < n; ++i) if (chosen[i] != 0) result.push_back(i);
+            }
+
+            return result;
+        }
+
+        /*!
+        * \brief Returns, in ascending order, the integers of [0, n) each kept independently with probability p.
+        *
+        * Draws one random number per kept integer: gaps between kept integers
+        * are geometrically distributed and are skipped in one step.
+        */
+        template<typename URBG>
+        std::vector<size_t> bernoulli_indices(size_t n, double p, URBG& rng)
+        {
+            std::vector<size_t> result;
+            if (p <= 0.0 || n == 0) return result;
+            if (p >= 1.0)
+            {
+                result.resize(n);
+                for (size_t i = 0; i < n; ++i) result[i] = i;
+                return result;
+            }
+
+            result.reserve(static_cast<size_t>(static_cast<double>(n) * p * 1.1) + 16);
+
+            const double log_q = std::log1p(-p);
+            for (double i = std::floor(std::log(open_unit(rng)) / log_q); i < static_cast<double>(n); i += std::floor(std::log(open_unit(rng)) / log_q) + 1.0)
+                result.push_back(static_cast<size_t>(i));
+
+            return result;
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Returns a new vector holding k rows of hv chosen uniformly without replacement, in their original order.
+    *
+    * Returns every row if hv holds fewer than k rows. Rows are chosen in
+    * O(k) random draws, then copied as by take().
+    */
+    template<typename T, typename... Types, typename URBG, typename Policy = sequential_policy>
+    vector<T, Types...> sample_rows(vector<T, Types...>& hv, size_t k, URBG& rng, Policy policy = Policy())
+    {
+        return take(hv, detail::sample_indices(rows(hv), k, rng), policy);
+    }
+
+    /*!
+    * \brief Returns a new vector holding each row of hv independently with probability p, in their original order.
+    */
+    template<typename T, typename... Types, typename URBG, typename Policy = sequential_policy>
+    vector<T, Types...> bernoulli_sample(vector<T, Types...>& hv, double p, URBG& rng, Policy policy = Policy())
+    {
+        if (!(p >= 0.0 && p <= 1.0))
+            throw std::invalid_argument("std::invalid_argument: Sampling probability must lie within [0, 1].");
+
+        return take(hv, detail::bernoulli_indices(rows(hv), p, rng), policy);
+    }
+
+    /*!
+    * \brief Uniform sample of at most k rows of a source vector, kept up to date as rows are appended to it.
+    *
+    * Rows appended since the last call are considered on the next sync() or
+    * sample(). Algorithm L skips directly from one accepted row to the next,
+    * so the cost grows with the number of rows accepted, about
+    * k (1 + log(n / k)), rather than with the n rows appended. If the source
+    * shrinks, or its generation() advances because rows were rewritten or
+    * removed in place, the sample is drawn again from scratch.
+    */
+    template<typename T, typename... Types>
+    class reservoir
+    {
+    public:
+        // Typedefs
+        typedef heterogeneous::vector<T, Types...> vector_type;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Builds a reservoir of k rows of source.
+        */
+        reservoir(vector_type& source, size_t k, std::uint64_t seed = 5489u) : source_(&source), capacity_(k), rng_(seed)
+        {
+            if (k == 0)
+                throw std::invalid_argument("std::invalid_argument: reservoir capacity must be greater than 0.");
+            rebuild();
+        };
+
+        // Methods
+        /*!
+        * \brief Returns the sample, after taking in rows appended to the source.
+        */
+        vector_type& sample()
+        {
+            sync();
+            return sample_;
+        }
+
+        /*!
+        * \brief Returns the maximum number of rows in the sample.
+        */
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        /*!
+        * \brief Returns the number of source rows the sample was drawn from.
+        */
+        size_t observed() const
+        {
+            return observed_;
+        }
+
+        /*!
+        * \brief Takes in rows appended to the source since the last call.
+        */
+        void sync()
+        {
+            const size_t n = rows(*source_);
+            if (n < observed_ || source_->generation() != generation_) rebuild();
+
+            // fill the reservoir with the first rows
+            for (; observed_ < n && observed_ < capacity_; ++observed_)
+            {
+                const size_t i = observed_;
+                sample_.for_each(*source_, [i](auto& S, auto& C) { S.push_back(C[i]); });
+                if (observed_ + 1 == capacity_) skip();
+            }
+
+            // then jump from one accepted row to the next
+            for (; next_ < n; skip())
+            {
+                const size_t i = next_;
+                const size_t slot = std::uniform_int_distribution<size_t>(0, capacity_ - 1)(rng_);
+                sample_.for_each(*source_, [i, slot](auto& S, auto& C) { S[slot] = C[i]; });
+            }
+
+            observed_ = n;
+        }
+
+        /*!
+        * \brief Discards the sample and draws it again from every row of the source.
+        */
+        void rebuild()
+        {
+            sample_ = vector_type();
+            generation_ = source_->generation();
+            observed_ = 0;
+            next_ = static_cast<size_t>(-1);
+            w_ = 1.0;
+        }
+
+    private:
+        vector_type* source_;
+        vector_type sample_;
+        size_t capacity_;
+        size_t generation_; // generation of the source the sample was drawn at
+        size_t observed_;
+        size_t next_; // next source row to enter the sample once the reservoir is full
+        double w_;
+        std::mt19937_64 rng_;
+
+        void skip()
+        {
+            if (next_ == static_cast<size_t>(-1)) next_ = capacity_ - 1;
+
+            const double k = static_cast<double>(capacity_);
+            w_ *= std::exp(std::log(detail::open_unit(rng_)) / k);
+
+            const double gap = std::floor(std::log(detail::open_unit(rng_)) / std::log1p(-w_));
+            next_ = gap < static_cast<double>(static_cast<size_t>(-1) - next_ - 1) ? next_ + static_cast<size_t>(gap) + 1 : static_cast<size_t>(-1);
+        }
+    };
+
+    /*!
+    * \brief Returns a reservoir of k rows of hv.
+    */
+    template<typename T, typename... Types>
+    reservoir<T, Types...> make_reservoir(vector<T, Types...>& hv, size_t k, std::uint64_t seed = 5489u)
+    {
+        return reservoir<T, Types...>(hv, k, seed);
+    }
+}
+
+#endif // HETEROGENEOUS_SAMPLE
@@ -0,0 +1,231 @@
+#ifndef HETEROGENEOUS_SCAN
+#define HETEROGENEOUS_SCAN
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file scan.hpp
+*
+* Inclusive and exclusive prefix scans (running totals, offsets) over
+* the containers of a heterogeneous::vector, in place or into another
+* container, single threaded or split across threads.
+*/
+
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        template<typename T, typename BinaryOp>
+        T reduce_range(const T* in, size_t first, size_t last, BinaryOp op)
+        {
+            T acc = in[first];
+            for (size_t i = first + 1; i < last; ++i) acc = op(acc, in[i]);
+            return acc;
+        }
+
+        template<typename T, typename BinaryOp>
+        void inclusive_scan_range(const T* in, T* out, size_t first, size_t last, BinaryOp op)
+        {
+            T acc = in[first];
+            out[first] = acc;
+            for (size_t i = first + 1; i < last; ++i) out[i] = acc = op(acc, in[i]);
+        }
+
+        template<typename T, typename BinaryOp>
+        void inclusive_scan_range(const T* in, T* out, size_t first, size_t last, T acc, BinaryOp op)
+        {
+            for (size_t i = first; i < last; ++i) out[i] = acc = op(acc, in[i]);
+        }
+
+        template<typename T, typename BinaryOp>
+        void exclusive_scan_range(const T* in, T* out, size_t first, size_t last, T acc, BinaryOp op)
+        {
+            // in and out may be the same container
+            for (size_t i = first; i < last; ++i)
+            {
+                const T v = in[i];
+                out[i] = acc;
+                acc = op(acc, v);
+            }
+        }
+
+        /*!
+        * \brief Number of blocks a parallel scan of n elements is split into.
+        *
+        * A block must be large enough for a thread to pay off, since the
+        * parallel scan reads every element twice.
+        */
+        inline size_t scan_blocks(size_t n)
+        {
+            const size_t blocks = n / (size_t(1) << 16);
+            return blocks < concurrency() ? blocks : concurrency();
+        }
+
+        /*!
+        * \brief Parallel scan: reduce each block, scan the block totals, then scan each block from its carry.
+        */
+        template<typename T, typename BinaryOp>
+        void parallel_scan(const T* in, T* out, size_t n, size_t blocks, const T* init, BinaryOp op)
+        {
+            std::vector<T> carry(blocks, T());
+
+            detail::parallel_for(blocks, 1, [&](size_t first, size_t last)
+            {
+                for (size_t b = first; b < last; ++b) carry[b] = reduce_range(in, n * b / blocks, n * (b + 1) / blocks, op);
+            });
+
+            // carry[b] becomes the combination of everything preceding block b
+            T acc = init != nullptr ? *init : carry[0];
+            for (size_t b = 0; b < blocks; ++b)
+            {
+                const T total = carry[b];
+                carry[b] = acc;
+                if (b > 0 || init != nullptr) acc = op(acc, total);
+            }
+
+            detail::parallel_for(blocks, 1, [&](size_t first, size_t last)
+            {
+                for (size_t b = first; b < last; ++b)
+                {
+                    const size_t begin = n * b / blocks;
+                    const size_t end = n * (b + 1) / blocks;
+
+                    if (init != nullptr) exclusive_scan_range(in, out, begin, end, carry[b], op);
+                    else if (b == 0) inclusive_scan_range(in, out, begin, end, op);
+                    else inclusive_scan_range(in, out, begin, end, carry[b], op);
+                }
+            });
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Writes out[i] = in[0] op in[1] op ... op in[i], resizing out to the size of in.
+    *
+    * in and out may be the same container.
+    */
+    template<typename T, typename BinaryOp = std::plus<T> >
+    void inclusive_scan(const std::vector<T>& in, std::vector<T>& out, BinaryOp op = BinaryOp())
+    {
+        out.resize(in.size());
+        if (!in.empty()) detail::inclusive_scan_range(in.data(), out.data(), 0, in.size(), op);
+    }
+
+    /*!
+    * \brief Same as inclusive_scan() but splits large containers across threads.
+    *
+    * op must be associative.
+    */
+    template<typename T, typename BinaryOp = std::plus<T> >
+    void inclusive_scan(const std::vector<T>& in, std::vector<T>& out, parallel_policy, BinaryOp op = BinaryOp())
+    {
+        const size_t blocks = detail::scan_blocks(in.size());
+        if (blocks <= 1) return inclusive_scan(in, out, op);
+
+        out.resize(in.size());
+        detail::parallel_scan(in.data(), out.data(), in.size(), blocks, static_cast<const T*>(nullptr), op);
+    }
+
+    /*!
+    * \brief Writes out[i] = init op in[0] op ... op in[i - 1], resizing out to the size of in.
+    *
+    * in and out may be the same container.
+    */
+    template<typename T, typename BinaryOp = std::plus<T> >
+    void exclusive_scan(const std::vector<T>& in, std::vector<T>& out, T init, BinaryOp op = BinaryOp())
+    {
+        out.resize(in.size());
+        detail::exclusive_scan_range(in.data(), out.data(), 0, in.size(), init, op);
+    }
+
+    /*!
+    * \brief Same as exclusive_scan() but splits large containers across threads.
+    *
+    * op must be associative.
+    */
+    template<typename T, typename BinaryOp = std::plus<T> >
+    void exclusive_scan(const std::vector<T>& in, std::vector<T>& out, T init, parallel_policy, BinaryOp op = BinaryOp())
+    {
+        const size_t blocks = detail::scan_blocks(in.size());
+        if (blocks <= 1) return exclusive_scan(in, out, init, op);
+
+        out.resize(in.size());
+        detail::parallel_scan(in.data(), out.data(), in.size(), blocks, &init, op);
+    }
+
+    /*!
+    * \brief Replaces the Nth container of type U in hv by its inclusive scan.
+    *
+    * Advances hv.generation(), as do the other in place scans of hv.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename BinaryOp = std::plus<U> >
+    void inclusive_scan(vector<T, Types...>& hv, BinaryOp op = BinaryOp())
+    {
+        std::vector<U>& c = hv.template get<U, N>();
+        inclusive_scan(c, c, op);
+        hv.touch();
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types, typename BinaryOp = std::plus<U> >
+    void inclusive_scan(vector<T, Types...>& hv, parallel_policy, BinaryOp op = BinaryOp())
+    {
+        std::vector<U>& c = hv.template get<U, N>();
+        inclusive_scan(c, c, par, op);
+        hv.touch();
+    }
+
+    /*!
+    * \brief Replaces the Nth container of type U in hv by its exclusive scan starting from init.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename BinaryOp = std::plus<U> >
+    void exclusive_scan(vector<T, Types...>& hv, U init, BinaryOp op = BinaryOp())
+    {
+        std::vector<U>& c = hv.template get<U, N>();
+        exclusive_scan(c, c, init, op);
+        hv.touch();
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types, typename BinaryOp = std::plus<U> >
+    void exclusive_scan(vector<T, Types...>& hv, U init, parallel_policy, BinaryOp op = BinaryOp())
+    {
+        std::vector<U>& c = hv.template get<U, N>();
+        exclusive_scan(c, c, init, par, op);
+        hv.touch();
+    }
+
+    /*!
+    * \brief Shorthand for the in place inclusive_scan() of the Nth container of type U.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename BinaryOp = std::plus<U> >
+    void scan(vector<T, Types...>& hv, BinaryOp op = BinaryOp())
+    {
+        inclusive_scan<U, N>(hv, op);
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types, typename BinaryOp = std::plus<U> >
+    void scan(vector<T, Types...>& hv, parallel_policy, BinaryOp op = BinaryOp())
+    {
+        inclusive_scan<U, N>(hv, par, op);
+    }
+}
+
+#endif // HETEROGENEOUS_SCAN
@@ -0,0 +1,218 @@
+#ifndef HETEROGENEOUS_SELECT
+#define HETEROGENEOUS_SELECT
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file select.hpp
+*
+* Selection by one container of a heterogeneous::vector: the row ids of
+* the k best rows without sorting the whole container, and an
+* nth_element which rearranges every container consistently.
+*/
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+#include "rows.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        /*!
+        * \brief Orders row ids by cmp of their elements, breaking ties by row id.
+        *
+        * Breaking ties makes the selected rows independent of the method and
+        * of how rows were split across threads.
+        */
+        template<typename U, typename Compare>
+        struct row_order
+        {
+            const std::vector<U>* c;
+            Compare cmp;
+
+            bool operator()(size_t a, size_t b) const
+            {
+                if (cmp((*c)[a], (*c)[b])) return true;
+                if (cmp((*c)[b], (*c)[a])) return false;
+                return a < b;
+            }
+        };
+
+        /*!
+        * \brief Appends to out, best first, the k best rows in [first, last).
+        *
+        * A bounded heap rejects most rows with one comparison when k is small
+        * relative to the range; otherwise a quickselect over row ids is cheaper.
+        */
+        template<typename U, typename Compare>
+        void select_range(const row_order<U, Compare>& order, size_t first, size_t last, size_t k, std::vector<size_t>& out)
+        {
+            const size_t n = last - first;
+            if (k > n) k = n;
+            if (k == 0) return;
+
+            std::vector<size_t> best;
+            if (k <= n / 16)
+            {
+                // max-heap on order: the worst of the best k is at the front
+                best.reserve(k);
+                for (size_t i = first; i < first + k; ++i) best.push_back(i);
+                std::make_heap(best.begin(), best.end(), order);
+
+                for (size_t i = first + k; i < last; ++i)
+                {
+                    if (!order(i, best.front())) continue;
+                    std::pop_heap(best.begin(), best.end(), order);
+                    best.back() = i;
+                    std::push_heap(best.begin(), best.end(), order);
+                }
+            }
+            else
+            {
+                best.resize(n);
+                std::iota(best.begin(), best.end(), first);
+                std::nth_element(best.begin(), best.begin() + (k - 1), best.end(), order);
+                best.resize(k);
+            }
+
+            std::sort(best.begin(), best.end(), order);
+            out.insert(out.end(), best.begin(), best.end());
+        }
+
+        inline void check_nth(size_t nth, size_t n)
+        {
+            if (nth >= n)
+                throw std::out_of_range(std::string("std::out_of_range: Row ") + std::to_string(nth) + std::string(" is out of range for ") + std::to_string(n) + std::string(" rows."));
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Returns the row ids of the k rows of hv ranked first by cmp on the Nth container of type U.
+    *
+    * Ids are ordered best first, ties going to the lower row id; by default
+    * these are the rows with the k largest elements. Returns every row id if
+    * hv holds fewer than k rows.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Compare = std::greater<U> >
+    std::vector<size_t> top_k(vector<T, Types...>& hv, size_t k, Compare cmp = Compare())
+    {
+        const std::vector<U>& c = hv.template get<U, N>();
+
+        std::vector<size_t> result;
+        detail::select_range(detail::row_order<U, Compare>{ &c, cmp }, 0, c.size(), k, result);
+        return result;
+    }
+
+    /*!
+    * \brief Same as top_k() but selects the best k of each block of rows in parallel, then merges them.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Compare = std::greater<U> >
+    std::vector<size_t> top_k(vector<T, Types...>& hv, size_t k, parallel_policy, Compare cmp = Compare())
+    {
+        const std::vector<U>& c = hv.template get<U, N>();
+        const detail::row_order<U, Compare> order{ &c, cmp };
+
+        // a block must be large enough to amortize its thread and the merge of its k candidates
+        const size_t n = c.size();
+        const size_t blocks = std::min(n / std::max(k * 4, size_t(1) << 16), detail::concurrency());
+        if (blocks <= 1) return top_k<U, N>(hv, k, cmp);
+
+        std::vector<std::vector<size_t> > candidates(blocks);
+        detail::parallel_for(blocks, 1, [&](size_t first, size_t last)
+        {
+            for (size_t b = first; b < last; ++b) detail::select_range(order, n * b / blocks, n * (b + 1) / blocks, k, candidates[b]);
+        });
+
+        std::vector<size_t> merged;
+        merged.reserve(blocks * k);
+        for (size_t b = 0; b < blocks; ++b) merged.insert(merged.end(), candidates[b].begin(), candidates[b].end());
+
+        if (merged.size() > k)
+        {
+            std::nth_element(merged.begin(), merged.begin() + (k - 1), merged.end(), order);
+            merged.resize(k);
+        }
+        std::sort(merged.begin(), merged.end(), order);
+        return merged;
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Compare = std::greater<U> >
+    std::vector<size_t> top_k(vector<T, Types...>& hv, size_t k, sequential_policy, Compare cmp = Compare())
+    {
+        return top_k<U, N>(hv, k, cmp);
+    }
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        template<typename U, size_t N, typename T, typename... Types, typename Compare, typename Policy>
+        void nth_element_by(vector<T, Types...>& hv, size_t nth, Compare cmp, Policy policy)
+        {
+            const std::vector<U>& c = hv.template get<U, N>();
+            check_nth(nth, c.size());
+
+            std::vector<size_t> order(c.size());
+            std::iota(order.begin(), order.end(), size_t(0));
+            std::nth_element(order.begin(), order.begin() + nth, order.end(), row_order<U, Compare>{ &c, cmp });
+
+            reorder_rows(hv, order, policy);
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief Rearranges the rows of hv so that row nth holds the row it would hold if sorted by cmp on the Nth container of type U.
+    *
+    * Rows before nth rank no later than it and rows after it no earlier,
+    * in unspecified order; every container is rearranged consistently and
+    * hv.generation() advances, as by reorder_rows(). Throws std::out_of_range
+    * if nth is not a row of hv.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Compare = std::less<U> >
+    void nth_element_by(vector<T, Types...>& hv, size_t nth, Compare cmp = Compare())
+    {
+        detail::nth_element_by<U, N>(hv, nth, cmp, seq);
+    }
+
+    /*!
+    * \brief Same as nth_element_by() but rearranges the containers in parallel.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Compare = std::less<U> >
+    void nth_element_by(vector<T, Types...>& hv, size_t nth, parallel_policy, Compare cmp = Compare())
+    {
+        detail::nth_element_by<U, N>(hv, nth, cmp, par);
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Compare = std::less<U> >
+    void nth_element_by(vector<T, Types...>& hv, size_t nth, sequential_policy, Compare cmp = Compare())
+    {
+        nth_element_by<U, N>(hv, nth, cmp);
+    }
+}
+
+#endif // HETEROGENEOUS_SELECT
@@ -0,0 +1,486 @@
+#ifndef HETEROGENEOUS_SHARDED
+#define HETEROGENEOUS_SHARDED
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file sharded.hpp
+*
+* sharded_vector, rows of a heterogeneous::vector partitioned among a
+* fixed number of shards, each a heterogeneous::vector with its own lock,
+* so that many threads can append rows at once. Rows go to the shards in
+* turn, or by the hash of one of their elements. Algorithms run per shard,
+* optionally concurrently, and a view presents every shard as one
+* sequence of rows.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+#include "rows.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        /*!
+        * \brief A shard: rows and the lock guarding them, padded so that locks of different shards do not share a cache line.
+        */
+        template<typename T, typename... Types>
+        struct shard
+        {
+            std::mutex mutex;
+            vector<T, Types...> rows;
+            char padding[64];
+        };
+
+        // std::hash is the identity for integers on common implementations; mixing spreads e.g. multiples of Shards
+        inline size_t spread(size_t h, size_t shards)
+        {
+            return static_cast<size_t>((static_cast<std::uint64_t>(h) * 0x9e3779b97f4a7c15ull) >> 32) % shards;
+        }
+
+        template<typename T, typename... Types>
+        void append_rows(vector<T, Types...>& dst, vector<T, Types...>& src)
+        {
+            dst.for_each(src, [](auto& D, auto& S)
+            {
+                if (D.empty()) D.swap(S);
+                else D.insert(D.end(), std::make_move_iterator(S.begin()), std::make_move_iterator(S.end()));
+            });
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief Rows of a heterogeneous::vector<T, Types...> partitioned among Shards vectors, each with its own lock.
+    *
+    * Appending locks a single shard, so threads appending concurrently
+    * rarely wait for each other. Rows appended with push_back() or
+    * append() go to the shards in turn, each thread starting from its own
+    * shard; rows appended with push_back_by()
+    * or append_by() go to the shard chosen by the hash of their Nth element
+    * of type U, so that equal keys share a shard. Order among rows of
+    * different shards is not kept.
+    */
+    template<size_t Shards, typename T, typename... Types>
+    class sharded_vector
+    {
+        static_assert(Shards > 0, "sharded_vector requires at least one shard.");
+
+    public:
+        // Typedefs
+        typedef vector<T, Types...> shard_type;
+
+        class view;
+
+        // Constructors & Destructors
+        sharded_vector()
+        {};
+
+        sharded_vector(const sharded_vector&) = delete;
+        sharded_vector& operator=(const sharded_vector&) = delete;
+
+        // Methods
+        /*!
+        * \brief Returns the number of shards.
+        */
+        static constexpr size_t shards()
+        {
+            return Shards;
+        }
+
+        /*!
+        * \brief Returns the shard push_back_by<U, N>() puts rows whose Nth element of type U equals key into.
+        */
+        template<typename U, size_t N = 0>
+        static size_t shard_of(const U& key)
+        {
+            static_assert(shard_type::template multiplicity<U>() > N, "heterogeneous::vector has no such container.");
+            return detail::spread(std::hash<U>()(key), Shards);
+        }
+
+        /*!
+        * \brief Appends a row to the next shard in turn. Returns the position of the shard.
+        */
+        size_t push_back(const T& value, const Types&... rest)
+        {
+            const size_t s = next_shard();
+
+            std::lock_guard<std::mutex> lock(shards_[s].mutex);
+            shards_[s].rows.push_back(value, rest...);
+            return s;
+        }
+
+        /*!
+        * \brief Appends a row to the shard chosen by its Nth element of type U. Returns the position of the shard.
+        */
+        template<typename U, size_t N = 0>
+        size_t push_back_by(const T& value, const Types&... rest)
+        {
+            // references to the arguments, of which only the key is read
+            const size_t s = shard_of<U, N>(std::get<shard_type::template index_of_v<U, N> >(std::forward_as_tuple(value, rest...)));
+
+            std::lock_guard<std::mutex> lock(shards_[s].mutex);
+            shards_[s].rows.push_back(value, rest...);
+            return s;
+        }
+
+        /*!
+        * \brief Moves every row of rows to the next shard in turn, locking it once, and leaves rows empty. Returns the position of the shard.
+        *
+        * Threads buffering rows locally and appending them in batches
+        * contend far less than threads appending rows one at a time. rows
+        * must hold the same number of elements in every container.
+        */
+        size_t append(shard_type& rows)
+        {
+            heterogeneous::rows(rows);
+
+            const size_t s = next_shard();
+            {
+                std::lock_guard<std::mutex> lock(shards_[s].mutex);
+                detail::append_rows(shards_[s].rows, rows);
+            }
+
+            rows.for_each([](auto& C) { C.clear(); });
+            return s;
+        }
+
+        /*!
+        * \brief Moves every row of rows to the shard chosen by its Nth element of type U, locking each shard once, and leaves rows empty.
+        */
+        template<typename U, size_t N = 0>
+        void append_by(shard_type& rows)
+        {
+            const size_t n = heterogeneous::rows(rows);
+
+            // partition outside of the locks
+            std::vector<std::vector<size_t> > members(Shards);
+            const std::vector<U>& keys = rows.template get<U, N>();
+            for (size_t i = 0; i < n; ++i) members[shard_of<U, N>(keys[i])].push_back(i);
+
+            for (size_t s = 0; s < Shards; ++s)
+            {
+                if (members[s].empty()) continue;
+
+                shard_type part = take(rows, members[s]);
+                std::lock_guard<std::mutex> lock(shards_[s].mutex);
+                detail::append_rows(shards_[s].rows, part);
+            }
+
+            rows.for_each([](auto& C) { C.clear(); });
+        }
+
+        /*!
+        * \brief Returns the number of rows of every shard together.
+        */
+        size_t rows()
+        {
+            size_t result = 0;
+            for (size_t s = 0; s < Shards; ++s)
+            {
+                std::lock_guard<std::mutex> lock(shards_[s].mutex);
+                result += shards_[s].rows.template get<T, 0>().size();
+            }
+            return result;
+        }
+
+        /*!
+        * \brief Removes every row of every shard.
+        */
+        void clear()
+        {
+            for_each_shard([](shard_type& rows, size_t) { rows.for_each([](auto& C) { C.clear(); }); });
+        }
+
+        /*!
+        * \brief Calls fn(rows) on shard s while holding its lock, and returns its result.
+        *
+        * If there is no shard s, throws std::out_of_range exception.
+        */
+        template<typename Function>
+        decltype(auto) with_shard(size_t s, Function fn)
+        {
+            if (s >= Shards)
+                throw std::out_of_range(std::string("std::out_of_range: Shard ") + std::to_string(s) + std::string(" does not exist in sharded_vector."));
+
+            std::lock_guard<std::mutex> lock(shards_[s].mutex);
+            return fn(shards_[s].rows);
+        }
+
+        /*!
+        * \brief Calls fn(rows, s) on every shard s in turn, holding the lock of that shard only.
+        */
+        template<typename Function>
+        Function for_each_shard(Function fn)
+        {
+            for (size_t s = 0; s < Shards; ++s)
+            {
+                std::lock_guard<std::mutex> lock(shards_[s].mutex);
+                fn(shards_[s].rows, s);
+            }
+            return fn;
+        }
+
+        /*!
+        * \brief Same as for_each_shard() but calls fn on the shards concurrently, one task each.
+        *
+        * fn must be safe to call from several threads at once on different
+        * shards. The first exception it throws is rethrown once every shard
+        * has been handled.
+        */
+        template<typename Function>
+        Function for_each_shard(parallel_policy, Function fn)
+        {
+            std::vector<std::function<void()> > tasks;
+            tasks.reserve(Shards);
+            for (size_t s = 0; s < Shards; ++s)
+            {
+                tasks.push_back([this, s, &fn]()
+                {
+                    std::lock_guard<std::mutex> lock(shards_[s].mutex);
+                    fn(shards_[s].rows, s);
+                });
+            }
+
+            detail::parallel_invoke(tasks);
+            return fn;
+        }
+
+        template<typename Function>
+        Function for_each_shard(sequential_policy, Function fn)
+        {
+            return for_each_shard(fn);
+        }
+
+        /*!
+        * \brief Returns init combined by reduce_op with transform_op(rows) for each shard, in shard order.
+        */
+        template<typename Result, typename BinaryOp, typename UnaryOp>
+        Result transform_reduce_shards(Result init, BinaryOp reduce_op, UnaryOp transform_op)
+        {
+            for_each_shard([&init, &reduce_op, &transform_op](shard_type& rows, size_t)
+            {
+                init = reduce_op(std::move(init), transform_op(rows));
+            });
+            return init;
+        }
+
+        /*!
+        * \brief Same as transform_reduce_shards() but evaluates transform_op on the shards concurrently.
+        *
+        * The results are then combined in shard order on the calling thread,
+        * so reduce_op need be neither associative nor commutative.
+        */
+        template<typename Result, typename BinaryOp, typename UnaryOp>
+        Result transform_reduce_shards(Result init, parallel_policy, BinaryOp reduce_op, UnaryOp transform_op)
+        {
+            std::vector<Result> results(Shards, init);
+            for_each_shard(par, [&results, &transform_op](shard_type& rows, size_t s) { results[s] = transform_op(rows); });
+
+            for (size_t s = 0; s < Shards; ++s) init = reduce_op(std::move(init), std::move(results[s]));
+            return init;
+        }
+
+        template<typename Result, typename BinaryOp, typename UnaryOp>
+        Result transform_reduce_shards(Result init, sequential_policy, BinaryOp reduce_op, UnaryOp transform_op)
+        {
+            return transform_reduce_shards(std::move(init), reduce_op, transform_op);
+        }
+
+        /*!
+        * \brief Locks every shard and returns a view presenting their rows as one sequence.
+        */
+        view lock_all()
+        {
+            return view(*this);
+        }
+
+        /*!
+        * \brief Every shard of a sharded_vector, locked for the lifetime of the view, as one sequence of rows.
+        *
+        * Rows are numbered shard after shard: the rows of shard 0 first, then
+        * those of shard 1 and so on. Shards are locked in order, so views
+        * taken by several threads do not deadlock; appending from the thread
+        * holding a view does.
+        */
+        class view
+        {
+        public:
+            /*!
+            * \brief Forward iterator over the elements of the Nth container of type U of every shard, shard after shard.
+            */
+            template<typename U, size_t N = 0>
+            class iterator
+            {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef U value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef U* pointer;
+                typedef U& reference;
+
+                iterator() : shards_(nullptr), shard_(Shards), row_(0)
+                {};
+
+                iterator(shard_type* const* shards, size_t shard, size_t row) : shards_(shards), shard_(shard), row_(row)
+                {
+                    skip_empty();
+                };
+
+                reference operator*() const { return shards_[shard_]->template get<U, N>()[row_]; }
+                pointer operator->() const { return &**this; }
+
+                iterator& operator++()
+                {
+                    ++row_;
+                    skip_empty();
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator result(*this);
+                    ++*this;
+                    return result;
+                }
+
+                bool operator==(const iterator& rhs) const { return shard_ == rhs.shard_ && row_ == rhs.row_; }
+                bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+
+            private:
+                shard_type* const* shards_;
+                size_t shard_;
+                size_t row_;
+
+                // past the end is shard Shards, row 0
+                void skip_empty()
+                {
+                    while (shard_ < Shards && row_ == shards_[shard_]->template get<U, N>().size())
+                    {
+                        ++shard_;
+                        row_ = 0;
+                    }
+                }
+            };
+
+            // Constructors & Destructors
+            explicit view(sharded_vector& sv)
+            {
+                locks_.reserve(Shards);
+                offsets_.push_back(0);
+                for (size_t s = 0; s < Shards; ++s)
+                {
+                    locks_.emplace_back(sv.shards_[s].mutex);
+                    shards_[s] = &sv.shards_[s].rows;
+                    offsets_.push_back(offsets_.back() + shards_[s]->template get<T, 0>().size());
+                }
+            };
+
+            // Methods
+            /*!
+            * \brief Returns the number of rows of every shard together.
+            */
+            size_t rows() const
+            {
+                return offsets_.back();
+            }
+
+            /*!
+            * \brief Returns the shard holding row i and the position of the row within it.
+            *
+            * If there is no row i, throws std::out_of_range exception.
+            */
+            std::pair<size_t, size_t> locate(size_t i) const
+            {
+                if (i >= rows())
+                    throw std::out_of_range(std::string("std::out_of_range: Row ") + std::to_string(i) + std::string(" does not exist in sharded_vector with ") + std::to_string(rows()) + std::string(" rows."));
+
+                const size_t s = std::upper_bound(offsets_.begin(), offsets_.end(), i) - offsets_.begin() - 1;
+                return std::make_pair(s, i - offsets_[s]);
+            }
+
+            /*!
+            * \brief Returns reference to the element of row i in the Nth container of type U.
+            */
+            template<typename U, size_t N = 0>
+            U& get(size_t i)
+            {
+                const std::pair<size_t, size_t> at = locate(i);
+                return shards_[at.first]->template get<U, N>()[at.second];
+            }
+
+            /*!
+            * \brief Returns shard s, which the view keeps locked.
+            */
+            shard_type& shard(size_t s)
+            {
+                return *shards_.at(s);
+            }
+
+            template<typename U, size_t N = 0>
+            iterator<U, N> begin()
+            {
+                return iterator<U, N>(shards_.data(), 0, 0);
+            }
+
+            template<typename U, size_t N = 0>
+            iterator<U, N> end()
+            {
+                return iterator<U, N>();
+            }
+
+            /*!
+            * \brief Calls fn(container) for each container of each shard, shard after shard.
+            */
+            template<typename Function>
+            Function for_each(Function fn)
+            {
+                for (size_t s = 0; s < Shards; ++s) shards_[s]->for_each(std::ref(fn));
+                return fn;
+            }
+
+        private:
+            std::vector<std::unique_lock<std::mutex> > locks_;
+            std::array<shard_type*, Shards> shards_;
+            std::vector<size_t> offsets_; // row number of the first row of each shard, then the number of rows
+        };
+
+    private:
+        std::array<detail::shard<T, Types...>, Shards> shards_;
+
+        // each thread takes the shards in turn from its own first shard, so appending threads share no counter
+        static size_t next_shard()
+        {
+            static thread_local size_t cursor = detail::spread(std::hash<std::thread::id>()(std::this_thread::get_id()), Shards);
+            return cursor++ % Shards;
+        }
+    };
+}
+
+#endif // HETEROGENEOUS_SHARDED
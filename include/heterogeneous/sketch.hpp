@@ -0,0 +1,615 @@
+#ifndef HETEROGENEOUS_SKETCH
+#define HETEROGENEOUS_SKETCH
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file sketch.hpp
+*
+* Streaming sketches of a container of a heterogeneous::vector: distinct
+* counts (HyperLogLog), frequencies and heavy hitters (Count-Min) and
+* quantiles (KLL). Each sketch follows its container on append, answers
+* in constant or near constant time and can be merged with a sketch of
+* another container.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "observer.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        inline std::uint64_t mix64(std::uint64_t h)
+        {
+            // std::hash is the identity for integers on common implementations
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        inline unsigned leading_zeros(std::uint64_t x)
+        {
+#if defined(__GNUC__)
+            return x == 0 ? 64 : static_cast<unsigned>(__builtin_clzll(x));
+#else
+            unsigned n = 0;
+            for (std::uint64_t bit = std::uint64_t(1) << 63; bit != 0 && (x & bit) == 0; bit >>= 1) ++n;
+            return n;
+#endif
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief HyperLogLog estimate of the number of distinct elements of a container.
+    *
+    * Uses 2^precision one byte registers; the relative standard error is
+    * about 1.04 / sqrt(2^precision), 0.8% at the default precision of 14.
+    */
+    template<typename T, typename Hash = std::hash<T> >
+    class hyperloglog : public lane_observer<hyperloglog<T, Hash>, T>
+    {
+        // Friends
+        friend class lane_observer<hyperloglog<T, Hash>, T>;
+
+    public:
+        // Typedefs
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Builds a HyperLogLog sketch of c.
+        *
+        * @param precision Base two logarithm of the number of registers, within [4, 18].
+        */
+        explicit hyperloglog(const container_type& c, unsigned precision = 14, const Hash& hash = Hash())
+            : lane_observer<hyperloglog<T, Hash>, T>(c), hash_(hash), precision_(precision)
+        {
+            if (precision < 4 || precision > 18)
+                throw std::invalid_argument("std::invalid_argument: hyperloglog precision must lie within [4, 18].");
+
+            registers_.resize(size_t(1) << precision_);
+            reset();
+            this->sync();
+        };
+
+        // Methods
+        /*!
+        * \brief Returns the estimated number of distinct elements.
+        */
+        double estimate()
+        {
+            this->sync();
+
+            const double m = static_cast<double>(registers_.size());
+            const double raw = 0.7213 / (1.0 + 1.079 / m) * m * m / inverse_sum_;
+
+            // linear counting is more accurate while many registers are empty
+            if (raw <= 2.5 * m && zeros_ != 0) return m * std::log(m / static_cast<double>(zeros_));
+            return raw;
+        }
+
+        /*!
+        * \brief Folds the sketch of another container into this one, which then summarizes both.
+        *
+        * Both sketches are brought up to date first. The result no longer
+        * follows a single container and is detached from it.
+        * Throws std::invalid_argument if the precisions differ.
+        */
+        void merge(hyperloglog& other)
+        {
+            if (other.precision_ != precision_)
+                throw std::invalid_argument("std::invalid_argument: Cannot merge hyperloglog sketches of different precisions.");
+
+            this->sync();
+            other.sync();
+            for (size_t i = 0; i < registers_.size(); ++i) update(i, other.registers_[i]);
+            this->detach();
+        }
+
+        /*!
+        * \brief Returns the base two logarithm of the number of registers.
+        */
+        unsigned precision() const
+        {
+            return precision_;
+        }
+
+    private:
+        Hash hash_;
+        unsigned precision_;
+        std::vector<std::uint8_t> registers_;
+        double inverse_sum_; // sum of 2^-register, kept current so estimate() need not scan
+        size_t zeros_;
+
+        void update(size_t i, std::uint8_t rank)
+        {
+            const std::uint8_t old = registers_[i];
+            if (rank <= old) return;
+
+            registers_[i] = rank;
+            inverse_sum_ += std::ldexp(1.0, -rank) - std::ldexp(1.0, -old);
+            if (old == 0) --zeros_;
+        }
+
+        void absorb(size_t first, size_t last)
+        {
+            const container_type& c = *this->container();
+            for (size_t i = first; i < last; ++i)
+            {
+                const std::uint64_t h = detail::mix64(hash_(c[i]));
+
+                // the top bits choose the register, the position of the first set bit of the rest is its rank
+                const std::uint64_t rest = (h << precision_) | (std::uint64_t(1) << (precision_ - 1));
+                update(static_cast<size_t>(h >> (64 - precision_)), static_cast<std::uint8_t>(detail::leading_zeros(rest) + 1));
+            }
+        }
+
+        void reset()
+        {
+            std::fill(registers_.begin(), registers_.end(), 0);
+            inverse_sum_ = static_cast<double>(registers_.size());
+            zeros_ = registers_.size();
+        }
+    };
+
+    /*!
+    * \brief Count-Min sketch of the frequencies of the elements of a container.
+    *
+    * Estimates never undercount and overcount by at most epsilon times the
+    * number of elements with probability 1 - delta. If tracked is not 0 the
+    * sketch also keeps the tracked elements with the largest estimates seen,
+    * which heavy_hitters() reports.
+    */
+    template<typename T, typename Hash = std::hash<T> >
+    class count_min : public lane_observer<count_min<T, Hash>, T>
+    {
+        // Friends
+        friend class lane_observer<count_min<T, Hash>, T>;
+
+    public:
+        // Typedefs
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Builds a Count-Min sketch of c.
+        *
+        * @param epsilon Overcount bound as a fraction of the number of elements, within (0, 1).
+        * @param delta Probability of exceeding the bound, within (0, 1).
+        * @param tracked Number of candidate heavy hitters to keep.
+        */
+        explicit count_min(const container_type& c, double epsilon = 0.001, double delta = 0.01, size_t tracked = 0, const Hash& hash = Hash())
+            : lane_observer<count_min<T, Hash>, T>(c), hash_(hash), tracked_(tracked), total_(0), floor_(0)
+        {
+            if (!(epsilon > 0.0 && epsilon < 1.0) || !(delta > 0.0 && delta < 1.0))
+                throw std::invalid_argument("std::invalid_argument: count_min epsilon and delta must lie within (0, 1).");
+
+            width_ = static_cast<size_t>(std::ceil(std::exp(1.0) / epsilon));
+            depth_ = static_cast<size_t>(std::ceil(std::log(1.0 / delta)));
+            if (depth_ == 0) depth_ = 1;
+
+            counters_.resize(width_ * depth_);
+            this->sync();
+        };
+
+        // Methods
+        /*!
+        * \brief Returns the estimated number of occurrences of v.
+        */
+        std::uint64_t estimate(const value_type& v)
+        {
+            this->sync();
+            return estimate_hash(detail::mix64(hash_(v)));
+        }
+
+        /*!
+        * \brief Returns the tracked elements estimated to make up at least fraction phi of all elements, most frequent first.
+        */
+        std::vector<std::pair<value_type, std::uint64_t> > heavy_hitters(double phi)
+        {
+            this->sync();
+
+            std::vector<std::pair<value_type, std::uint64_t> > result;
+            for (const auto& candidate : candidates_)
+            {
+                if (static_cast<double>(candidate.second) >= phi * static_cast<double>(total_)) result.push_back(candidate);
+            }
+
+            std::sort(result.begin(), result.end(), [](const std::pair<value_type, std::uint64_t>& a, const std::pair<value_type, std::uint64_t>& b)
+            {
+                return a.second > b.second;
+            });
+            return result;
+        }
+
+        /*!
+        * \brief Returns the number of elements summarized.
+        */
+        std::uint64_t total()
+        {
+            this->sync();
+            return total_;
+        }
+
+        /*!
+        * \brief Folds the sketch of another container into this one, which then summarizes both.
+        *
+        * Both sketches are brought up to date first. The result no longer
+        * follows a single container and is detached from it.
+        * Throws std::invalid_argument if the dimensions differ.
+        */
+        void merge(count_min& other)
+        {
+            if (other.width_ != width_ || other.depth_ != depth_)
+                throw std::invalid_argument("std::invalid_argument: Cannot merge count_min sketches of different dimensions.");
+
+            this->sync();
+            other.sync();
+
+            for (size_t i = 0; i < counters_.size(); ++i) counters_[i] += other.counters_[i];
+            total_ += other.total_;
+
+            // re-estimate every candidate of either side against the merged counters
+            std::unordered_map<value_type, std::uint64_t, Hash> candidates(std::move(candidates_));
+            for (const auto& candidate : other.candidates_) candidates.emplace(candidate.first, 0);
+
+            candidates_.clear();
+            floor_ = 0;
+            for (const auto& candidate : candidates) track(candidate.first, estimate_hash(detail::mix64(hash_(candidate.first))));
+
+            this->detach();
+        }
+
+    private:
+        Hash hash_;
+        size_t width_;
+        size_t depth_;
+        size_t tracked_;
+        std::uint64_t total_;
+        std::uint64_t floor_; // smallest candidate count once all tracked slots are taken, else 0
+        std::vector<std::uint64_t> counters_;
+        std::unordered_map<value_type, std::uint64_t, Hash> candidates_;
+
+        size_t column(std::uint64_t h, size_t row) const
+        {
+            // double hashing: row i probes h1 + i * h2, reduced onto the width without a division
+            const std::uint64_t probe = (h >> 32) + row * ((h & 0xffffffffULL) | 1);
+            return static_cast<size_t>(((probe & 0xffffffffULL) * static_cast<std::uint64_t>(width_)) >> 32);
+        }
+
+        std::uint64_t estimate_hash(std::uint64_t h) const
+        {
+            std::uint64_t result = counters_[column(h, 0)];
+            for (size_t row = 1; row < depth_; ++row) result = std::min(result, counters_[row * width_ + column(h, row)]);
+            return result;
+        }
+
+        void track(const value_type& v, std::uint64_t count)
+        {
+            if (tracked_ == 0) return;
+
+            auto it = candidates_.find(v);
+            if (it != candidates_.end())
+            {
+                const std::uint64_t old = it->second;
+                it->second = count;
+                if (old == floor_) update_floor();
+                return;
+            }
+            if (candidates_.size() < tracked_)
+            {
+                candidates_.emplace(v, count);
+                update_floor();
+                return;
+            }
+            if (count <= floor_) return;
+
+            auto smallest = candidates_.begin();
+            for (auto c = candidates_.begin(); c != candidates_.end(); ++c) if (c->second < smallest->second) smallest = c;
+
+            candidates_.erase(smallest);
+            candidates_.emplace(v, count);
+            update_floor();
+        }
+
+        /*!
+        * \brief Recomputes the smallest count an element needs to become a candidate.
+        */
+        void update_floor()
+        {
+            floor_ = 0;
+            if (candidates_.size() < tracked_) return;
+
+            floor_ = candidates_.begin()->second;
+            for (const auto& candidate : candidates_) floor_ = std::min(floor_, candidate.second);
+        }
+
+        void absorb(size_t first, size_t last)
+        {
+            const container_type& c = *this->container();
+            for (size_t i = first; i < last; ++i)
+            {
+                const std::uint64_t h = detail::mix64(hash_(c[i]));
+
+                std::uint64_t count = ++counters_[column(h, 0)];
+                for (size_t row = 1; row < depth_; ++row) count = std::min(count, ++counters_[row * width_ + column(h, row)]);
+
+                // only an element whose estimate exceeds the smallest candidate can change the candidates
+                if (tracked_ != 0 && count > floor_) track(c[i], count);
+            }
+            total_ += last - first;
+        }
+
+        void reset()
+        {
+            std::fill(counters_.begin(), counters_.end(), 0);
+            candidates_.clear();
+            total_ = 0;
+            floor_ = 0;
+        }
+    };
+
+    /*!
+    * \brief KLL sketch of the distribution of the elements of a container, answering quantile and rank queries.
+    *
+    * Keeps O(k) elements; ranks are within about 1.7 / k of all elements
+    * (under 1% for the default k of 200) with high probability. Only
+    * operator< of T is used.
+    */
+    template<typename T>
+    class kll_sketch : public lane_observer<kll_sketch<T>, T>
+    {
+        // Friends
+        friend class lane_observer<kll_sketch<T>, T>;
+
+    public:
+        // Typedefs
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Builds a KLL sketch of c keeping about 3k elements.
+        */
+        explicit kll_sketch(const container_type& c, size_t k = 200)
+            : lane_observer<kll_sketch<T>, T>(c), k_(k), count_(0), random_(0x9e3779b97f4a7c15ULL), sorted_valid_(false)
+        {
+            if (k_ < 8)
+                throw std::invalid_argument("std::invalid_argument: kll_sketch k must be at least 8.");
+
+            levels_.resize(1);
+            this->sync();
+        };
+
+        // Methods
+        /*!
+        * \brief Returns the element at normalized rank q, so that about q of all elements precede it.
+        *
+        * Throws std::invalid_argument if q lies outside [0, 1] and
+        * std::out_of_range if no element has been summarized.
+        */
+        value_type quantile(double q)
+        {
+            if (!(q >= 0.0 && q <= 1.0))
+                throw std::invalid_argument("std::invalid_argument: kll_sketch quantile must lie within [0, 1].");
+
+            const std::vector<std::pair<value_type, std::uint64_t> >& sorted = weighted();
+            if (sorted.empty())
+                throw std::out_of_range("std::out_of_range: kll_sketch of an empty container has no quantiles.");
+
+            const double target = q * static_cast<double>(count_);
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), target, [](const std::pair<value_type, std::uint64_t>& e, double t)
+            {
+                return static_cast<double>(e.second) < t;
+            });
+            return it == sorted.end() ? sorted.back().first : it->first;
+        }
+
+        /*!
+        * \brief Returns the estimated fraction of elements less than or equal to v.
+        */
+        double rank(const value_type& v)
+        {
+            const std::vector<std::pair<value_type, std::uint64_t> >& sorted = weighted();
+            if (sorted.empty()) return 0.0;
+
+            auto it = std::upper_bound(sorted.begin(), sorted.end(), v, [](const value_type& x, const std::pair<value_type, std::uint64_t>& e)
+            {
+                return x < e.first;
+            });
+            return it == sorted.begin() ? 0.0 : static_cast<double>((it - 1)->second) / static_cast<double>(count_);
+        }
+
+        /*!
+        * \brief Returns the number of elements summarized.
+        */
+        std::uint64_t count()
+        {
+            this->sync();
+            return count_;
+        }
+
+        /*!
+        * \brief Folds the sketch of another container into this one, which then summarizes both.
+        *
+        * Both sketches are brought up to date first. The result no longer
+        * follows a single container and is detached from it.
+        */
+        void merge(kll_sketch& other)
+        {
+            this->sync();
+            other.sync();
+
+            if (levels_.size() < other.levels_.size()) levels_.resize(other.levels_.size());
+            for (size_t h = 0; h < other.levels_.size(); ++h) levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+
+            count_ += other.count_;
+            while (retained() > capacity()) compact();
+
+            sorted_valid_ = false;
+            this->detach();
+        }
+
+    private:
+        size_t k_;
+        std::uint64_t count_;
+        std::uint64_t random_;
+        std::vector<std::vector<T> > levels_; // level h holds elements of weight 2^h
+        std::vector<std::pair<T, std::uint64_t> > sorted_; // retained elements with cumulative weights
+        bool sorted_valid_;
+
+        size_t capacity(size_t h) const
+        {
+            // capacities shrink geometrically by 2/3 from the top level down
+            const double c = std::ceil(static_cast<double>(k_) * std::pow(2.0 / 3.0, static_cast<double>(levels_.size() - 1 - h)));
+            return c < 2.0 ? 2 : static_cast<size_t>(c);
+        }
+
+        size_t capacity() const
+        {
+            size_t result = 0;
+            for (size_t h = 0; h < levels_.size(); ++h) result += capacity(h);
+            return result;
+        }
+
+        size_t retained() const
+        {
+            size_t result = 0;
+            for (size_t h = 0; h < levels_.size(); ++h) result += levels_[h].size();
+            return result;
+        }
+
+        bool coin()
+        {
+            random_ ^= random_ << 13;
+            random_ ^= random_ >> 7;
+            random_ ^= random_ << 17;
+            return (random_ & 1) != 0;
+        }
+
+        /*!
+        * \brief Halves the lowest full level, promoting every other element of it to the level above.
+        */
+        void compact()
+        {
+            size_t h = 0;
+            while (levels_[h].size() < capacity(h)) ++h;
+            if (h + 1 == levels_.size()) levels_.emplace_back();
+
+            std::vector<T>& level = levels_[h];
+            std::sort(level.begin(), level.end());
+
+            // an odd element out stays behind at its weight
+            const size_t paired = level.size() & ~size_t(1);
+            for (size_t i = coin() ? 1 : 0; i < paired; i += 2) levels_[h + 1].push_back(level[i]);
+            level.erase(level.begin(), level.begin() + paired);
+        }
+
+        const std::vector<std::pair<T, std::uint64_t> >& weighted()
+        {
+            this->sync();
+            if (sorted_valid_) return sorted_;
+
+            sorted_.clear();
+            for (size_t h = 0; h < levels_.size(); ++h)
+            {
+                for (const T& v : levels_[h]) sorted_.emplace_back(v, std::uint64_t(1) << h);
+            }
+
+            std::sort(sorted_.begin(), sorted_.end(), [](const std::pair<T, std::uint64_t>& a, const std::pair<T, std::uint64_t>& b)
+            {
+                return a.first < b.first;
+            });
+            for (size_t i = 1; i < sorted_.size(); ++i) sorted_[i].second += sorted_[i - 1].second;
+
+            sorted_valid_ = true;
+            return sorted_;
+        }
+
+        void absorb(size_t first, size_t last)
+        {
+            const container_type& c = *this->container();
+            for (size_t i = first; i < last; ++i)
+            {
+                levels_[0].push_back(c[i]);
+                if (levels_[0].size() >= capacity(0) && retained() > capacity()) compact();
+            }
+
+            count_ += last - first;
+            sorted_valid_ = false;
+        }
+
+        void reset()
+        {
+            levels_.assign(1, std::vector<T>());
+            count_ = 0;
+            sorted_valid_ = false;
+        }
+    };
+
+    /*!
+    * \brief Returns a hyperloglog sketch of the Nth container of type U in hv.
+    *
+    * Like the other sketches made from hv, it watches hv.generation() and is
+    * recomputed after rows of hv are rewritten or removed in place.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    hyperloglog<U> make_hyperloglog(vector<T, Types...>& hv, unsigned precision = 14)
+    {
+        hyperloglog<U> result(hv.template get<U, N>(), precision);
+        result.watch(hv.generation());
+        return result;
+    }
+
+    /*!
+    * \brief Returns a count_min sketch of the Nth container of type U in hv.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    count_min<U> make_count_min(vector<T, Types...>& hv, double epsilon = 0.001, double delta = 0.01, size_t tracked = 0)
+    {
+        count_min<U> result(hv.template get<U, N>(), epsilon, delta, tracked);
+        result.watch(hv.generation());
+        return result;
+    }
+
+    /*!
+    * \brief Returns a kll_sketch of the Nth container of type U in hv.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    kll_sketch<U> make_kll_sketch(vector<T, Types...>& hv, size_t k = 200)
+    {
+        kll_sketch<U> result(hv.template get<U, N>(), k);
+        result.watch(hv.generation());
+        return result;
+    }
+}
+
+#endif // HETEROGENEOUS_SKETCH
@@ -0,0 +1,463 @@
+#ifndef HETEROGENEOUS_SORT
+#define HETEROGENEOUS_SORT
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file sort.hpp
+*
+* Sorting of the containers of a heterogeneous::vector. Integer and
+* floating point containers are sorted with an LSD radix sort, others
+* with std::sort; large containers can be sorted in parallel with a
+* sample sort. Key/row id variants sort every container of the vector
+* by one of them.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+#include "rows.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        template<size_t Bytes> struct unsigned_of;
+        template<> struct unsigned_of<1> { typedef std::uint8_t type; };
+        template<> struct unsigned_of<2> { typedef std::uint16_t type; };
+        template<> struct unsigned_of<4> { typedef std::uint32_t type; };
+        template<> struct unsigned_of<8> { typedef std::uint64_t type; };
+
+        template<typename T>
+        struct is_radix_sortable : std::integral_constant<bool,
+            std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8 &&
+            (std::is_integral<T>::value || std::numeric_limits<T>::is_iec559)>
+        {};
+
+        /*!
+        * \brief Maps T to an unsigned integer whose order matches the order of T.
+        */
+        template<typename T, bool Integral = std::is_integral<T>::value>
+        struct radix_key
+        {
+            // floating point: flip every bit of negatives, only the sign bit of positives
+            typedef typename unsigned_of<sizeof(T)>::type type;
+            static const type sign = type(1) << (8 * sizeof(T) - 1);
+
+            static type encode(T v)
+            {
+                type k;
+                std::memcpy(&k, &v, sizeof(T));
+                return (k & sign) ? type(~k) : type(k | sign);
+            }
+        };
+
+        template<typename T>
+        struct radix_key<T, true>
+        {
+            // signed integers: flip the sign bit
+            typedef typename unsigned_of<sizeof(T)>::type type;
+            static const type sign = std::is_signed<T>::value ? type(type(1) << (8 * sizeof(T) - 1)) : type(0);
+
+            static type encode(T v)
+            {
+                return type(type(v) ^ sign);
+            }
+        };
+
+        /*!
+        * \brief Stable LSD radix sort of [data, data + n), 8 bits per pass.
+        *
+        * buffer must hold n elements. If rows is not null, rows[i] is moved
+        * along with data[i]; row_buffer must then hold n elements as well.
+        * Passes in which every key has the same digit are skipped.
+        */
+        template<typename T>
+        void radix_sort(T* data, T* buffer, size_t n, size_t* rows, size_t* row_buffer)
+        {
+            typedef radix_key<T> key;
+            const size_t passes = sizeof(T);
+
+            std::vector<size_t> counts(passes * 256, 0);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const typename key::type k = key::encode(data[i]);
+                for (size_t p = 0; p < passes; ++p) ++counts[p * 256 + ((k >> (8 * p)) & 0xff)];
+            }
+
+            T* src = data;
+            T* dst = buffer;
+            size_t* row_src = rows;
+            size_t* row_dst = row_buffer;
+
+            for (size_t p = 0; p < passes; ++p)
+            {
+                size_t* count = &counts[p * 256];
+                if (std::find(count, count + 256, n) != count + 256) continue;
+
+                size_t offset = 0;
+                for (size_t b = 0; b < 256; ++b)
+                {
+                    const size_t c = count[b];
+                    count[b] = offset;
+                    offset += c;
+                }
+
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const size_t b = (key::encode(src[i]) >> (8 * p)) & 0xff;
+                    const size_t j = count[b]++;
+                    dst[j] = src[i];
+                    if (rows != nullptr) row_dst[j] = row_src[i];
+                }
+
+                std::swap(src, dst);
+                std::swap(row_src, row_dst);
+            }
+
+            if (src != data)
+            {
+                std::copy(src, src + n, data);
+                if (rows != nullptr) std::copy(row_src, row_src + n, rows);
+            }
+        }
+
+        template<typename T>
+        void sort_range(T* first, T* last, std::true_type /*radix sortable*/)
+        {
+            std::vector<T> buffer(last - first);
+            radix_sort(first, buffer.data(), last - first, static_cast<size_t*>(nullptr), static_cast<size_t*>(nullptr));
+        }
+
+        template<typename T>
+        void sort_range(T* first, T* last, std::false_type)
+        {
+            std::sort(first, last);
+        }
+
+        template<typename T>
+        void sort_indices(const std::vector<T>& c, std::vector<size_t>& order, std::true_type /*radix sortable*/)
+        {
+            std::vector<T> keys(c);
+            std::vector<T> buffer(c.size());
+            std::vector<size_t> row_buffer(c.size());
+            radix_sort(keys.data(), buffer.data(), keys.size(), order.data(), row_buffer.data());
+        }
+
+        template<typename T>
+        void sort_indices(const std::vector<T>& c, std::vector<size_t>& order, std::false_type)
+        {
+            std::stable_sort(order.begin(), order.end(), [&c](size_t a, size_t b) { return c[a] < c[b]; });
+        }
+
+        /*!
+        * \brief Key by which elements of type T are ordered.
+        *
+        * Radix sortable types are ordered by their radix key, so comparison based
+        * paths agree with radix_sort on -0.0 and NaNs and stay a strict weak
+        * ordering; other types are ordered by operator<.
+        */
+        template<typename T, bool Radix = is_radix_sortable<T>::value>
+        struct sort_key
+        {
+            typedef T type;
+
+            static const T& encode(const T& v)
+            {
+                return v;
+            }
+        };
+
+        template<typename T>
+        struct sort_key<T, true>
+        {
+            typedef typename radix_key<T>::type type;
+
+            static type encode(T v)
+            {
+                return radix_key<T>::encode(v);
+            }
+        };
+
+        template<typename T>
+        struct sort_key_less
+        {
+            bool operator()(const T& lhs, const T& rhs) const
+            {
+                return sort_key<T>::encode(lhs) < sort_key<T>::encode(rhs);
+            }
+        };
+
+        /*!
+        * \brief Key of a row, ordered by key then row so that ties keep row order.
+        */
+        template<typename T>
+        struct keyed_row
+        {
+            typename sort_key<T>::type key;
+            size_t row;
+
+            bool operator<(const keyed_row& rhs) const
+            {
+                if (key < rhs.key) return true;
+                if (rhs.key < key) return false;
+                return row < rhs.row;
+            }
+        };
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Sorts c in ascending order with an LSD radix sort.
+    *
+    * Floating point values are ordered by their bit patterns after key
+    * transformation: -0.0 precedes 0.0 and NaNs are gathered at either end.
+    */
+    template<typename T>
+    void radix_sort(std::vector<T>& c)
+    {
+        static_assert(detail::is_radix_sortable<T>::value, "radix_sort requires an integer or IEEE floating point type.");
+        detail::sort_range(c.data(), c.data() + c.size(), std::true_type());
+    }
+
+    /*!
+    * \brief Stable radix sort of keys, applying the same rearrangement to rows.
+    *
+    * rows must hold as many elements as keys; typically row ids used to reorder
+    * further containers afterwards.
+    */
+    template<typename T>
+    void radix_sort(std::vector<T>& keys, std::vector<size_t>& rows)
+    {
+        static_assert(detail::is_radix_sortable<T>::value, "radix_sort requires an integer or IEEE floating point type.");
+        if (keys.size() != rows.size())
+            throw std::invalid_argument("std::invalid_argument: radix_sort keys and rows hold different numbers of elements.");
+
+        std::vector<T> buffer(keys.size());
+        std::vector<size_t> row_buffer(rows.size());
+        detail::radix_sort(keys.data(), buffer.data(), keys.size(), rows.data(), row_buffer.data());
+    }
+
+    /*!
+    * \brief Sorts c in parallel with a sample sort.
+    *
+    * Elements are distributed among one bucket per thread using splitters drawn
+    * from a sorted sample, then buckets are sorted concurrently with
+    * sort_bucket(first, last), which receives pointers to the bucket elements.
+    */
+    template<typename T, typename Compare, typename BucketSort>
+    void sample_sort(std::vector<T>& c, Compare cmp, BucketSort sort_bucket)
+    {
+        const size_t n = c.size();
+        const size_t buckets = detail::concurrency();
+        if (buckets == 1 || n < (size_t(1) << 16))
+        {
+            sort_bucket(c.data(), c.data() + n);
+            return;
+        }
+
+        // splitters from an evenly spaced, oversampled sample
+        const size_t oversample = 64;
+        std::vector<T> sample;
+        sample.reserve(buckets * oversample);
+        for (size_t i = 0; i < buckets * oversample; ++i) sample.push_back(c[(2 * i + 1) * n / (2 * buckets * oversample)]);
+        std::sort(sample.begin(), sample.end(), cmp);
+
+        std::vector<T> splitters;
+        for (size_t b = 1; b < buckets; ++b) splitters.push_back(sample[b * oversample]);
+
+        // classify each chunk, counting bucket sizes per chunk
+        const size_t chunks = buckets;
+        std::vector<std::uint32_t> bucket_of(n);
+        std::vector<size_t> offsets(chunks * buckets, 0);
+
+        detail::parallel_for(chunks, 1, [&](size_t first, size_t last)
+        {
+            for (size_t t = first; t < last; ++t)
+            {
+                for (size_t i = n * t / chunks; i < n * (t + 1) / chunks; ++i)
+                {
+                    const size_t b = std::upper_bound(splitters.begin(), splitters.end(), c[i], cmp) - splitters.begin();
+                    bucket_of[i] = static_cast<std::uint32_t>(b);
+                    ++offsets[t * buckets + b];
+                }
+            }
+        });
+
+        // bucket major prefix sum gives where each chunk writes into each bucket
+        std::vector<size_t> bucket_begin(buckets + 1, 0);
+        size_t offset = 0;
+        for (size_t b = 0; b < buckets; ++b)
+        {
+            bucket_begin[b] = offset;
+            for (size_t t = 0; t < chunks; ++t)
+            {
+                const size_t count = offsets[t * buckets + b];
+                offsets[t * buckets + b] = offset;
+                offset += count;
+            }
+        }
+        bucket_begin[buckets] = n;
+
+        std::vector<T> temp(n);
+        detail::parallel_for(chunks, 1, [&](size_t first, size_t last)
+        {
+            for (size_t t = first; t < last; ++t)
+            {
+                for (size_t i = n * t / chunks; i < n * (t + 1) / chunks; ++i)
+                {
+                    temp[offsets[t * buckets + bucket_of[i]]++] = std::move(c[i]);
+                }
+            }
+        });
+
+        detail::parallel_for(buckets, 1, [&](size_t first, size_t last)
+        {
+            for (size_t b = first; b < last; ++b)
+            {
+                sort_bucket(temp.data() + bucket_begin[b], temp.data() + bucket_begin[b + 1]);
+            }
+        });
+
+        c.swap(temp);
+    }
+
+    /*!
+    * \brief Sorts c in parallel with a sample sort, sorting buckets with std::sort.
+    */
+    template<typename T, typename Compare = std::less<T> >
+    void sample_sort(std::vector<T>& c, Compare cmp = Compare())
+    {
+        sample_sort(c, cmp, [&cmp](T* first, T* last) { std::sort(first, last, cmp); });
+    }
+
+    /*!
+    * \brief Sorts the Nth container of type U in hv in ascending order.
+    *
+    * Only that container is rearranged; see sort_rows() to keep rows together.
+    * Advances hv.generation().
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    void sort(vector<T, Types...>& hv)
+    {
+        std::vector<U>& c = hv.template get<U, N>();
+        detail::sort_range(c.data(), c.data() + c.size(), detail::is_radix_sortable<U>());
+        hv.touch();
+    }
+
+    /*!
+    * \brief Same as sort() but sorts large containers in parallel.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    void sort(vector<T, Types...>& hv, parallel_policy)
+    {
+        sample_sort(hv.template get<U, N>(), detail::sort_key_less<U>(), [](U* first, U* last)
+        {
+            detail::sort_range(first, last, detail::is_radix_sortable<U>());
+        });
+        hv.touch();
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    void sort(vector<T, Types...>& hv, sequential_policy)
+    {
+        sort<U, N>(hv);
+    }
+
+    /*!
+    * \brief Returns the row ids of hv ordered by the Nth container of type U.
+    *
+    * The order is stable: rows with equal keys keep their relative order.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    std::vector<size_t> sort_indices(vector<T, Types...>& hv)
+    {
+        const std::vector<U>& c = hv.template get<U, N>();
+        std::vector<size_t> order(c.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+
+        detail::sort_indices(c, order, detail::is_radix_sortable<U>());
+        return order;
+    }
+
+    /*!
+    * \brief Same as sort_indices() but sorts large containers in parallel.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    std::vector<size_t> sort_indices(vector<T, Types...>& hv, parallel_policy)
+    {
+        const std::vector<U>& c = hv.template get<U, N>();
+
+        std::vector<detail::keyed_row<U> > keyed(c.size());
+        detail::parallel_for(c.size(), 1 << 16, [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i)
+            {
+                keyed[i].key = detail::sort_key<U>::encode(c[i]);
+                keyed[i].row = i;
+            }
+        });
+
+        sample_sort(keyed, std::less<detail::keyed_row<U> >(), [](detail::keyed_row<U>* first, detail::keyed_row<U>* last)
+        {
+            std::sort(first, last);
+        });
+
+        std::vector<size_t> order(keyed.size());
+        for (size_t i = 0; i < keyed.size(); ++i) order[i] = keyed[i].row;
+        return order;
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    std::vector<size_t> sort_indices(vector<T, Types...>& hv, sequential_policy)
+    {
+        return sort_indices<U, N>(hv);
+    }
+
+    /*!
+    * \brief Sorts the rows of hv by the Nth container of type U, keeping rows together.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    void sort_rows(vector<T, Types...>& hv)
+    {
+        reorder_rows(hv, sort_indices<U, N>(hv));
+    }
+
+    /*!
+    * \brief Same as sort_rows() but sorts and rearranges containers in parallel.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    void sort_rows(vector<T, Types...>& hv, parallel_policy)
+    {
+        reorder_rows(hv, sort_indices<U, N>(hv, par), par);
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    void sort_rows(vector<T, Types...>& hv, sequential_policy)
+    {
+        sort_rows<U, N>(hv);
+    }
+}
+
+#endif // HETEROGENEOUS_SORT
@@ -0,0 +1,277 @@
+#ifndef HETEROGENEOUS_STATISTICS
+#define HETEROGENEOUS_STATISTICS
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file statistics.hpp
+*
+* Count, mean, variance, minimum and maximum of arithmetic containers of
+* a heterogeneous::vector, computed in one numerically stable pass
+* (Welford) and combined across partial results (Chan et al.), either
+* once or kept up to date as elements are appended.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "observer.hpp"
+#include "parallel.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Running count, mean, sum of squared deviations, minimum and maximum of a sequence of values.
+    *
+    * Partial statistics of disjoint sequences, for instance of blocks
+    * handled by different threads, combine exactly with merge().
+    */
+    template<typename T>
+    struct statistics
+    {
+        static_assert(std::is_arithmetic<T>::value, "heterogeneous::statistics requires an arithmetic type.");
+
+        std::uint64_t count; //!< number of values
+        double mean;         //!< arithmetic mean, 0 if there are no values
+        double m2;           //!< sum of squared deviations from the mean
+        T min;               //!< smallest value, meaningless if there are no values
+        T max;               //!< largest value, meaningless if there are no values
+
+        statistics() : count(0), mean(0.0), m2(0.0), min(), max()
+        {};
+
+        /*!
+        * \brief Adds x to the sequence.
+        */
+        void push(T x)
+        {
+            ++count;
+            if (count == 1) min = max = x;
+            else
+            {
+                if (x < min) min = x;
+                if (max < x) max = x;
+            }
+
+            const double delta = static_cast<double>(x) - mean;
+            mean += delta / static_cast<double>(count);
+            m2 += delta * (static_cast<double>(x) - mean);
+        }
+
+        /*!
+        * \brief Combines the statistics of another sequence, as if its values had been pushed.
+        */
+        void merge(const statistics& other)
+        {
+            if (other.count == 0) return;
+            if (count == 0)
+            {
+                *this = other;
+                return;
+            }
+
+            const double n = static_cast<double>(count + other.count);
+            const double delta = other.mean - mean;
+
+            mean += delta * static_cast<double>(other.count) / n;
+            m2 += other.m2 + delta * delta * static_cast<double>(count) * static_cast<double>(other.count) / n;
+            count += other.count;
+
+            if (other.min < min) min = other.min;
+            if (max < other.max) max = other.max;
+        }
+
+        /*!
+        * \brief Returns the population variance, 0 if there are no values.
+        */
+        double variance() const
+        {
+            return count == 0 ? 0.0 : m2 / static_cast<double>(count);
+        }
+
+        /*!
+        * \brief Returns the unbiased sample variance, 0 if there are fewer than two values.
+        */
+        double sample_variance() const
+        {
+            return count < 2 ? 0.0 : m2 / static_cast<double>(count - 1);
+        }
+
+        /*!
+        * \brief Returns the population standard deviation.
+        */
+        double standard_deviation() const
+        {
+            return std::sqrt(variance());
+        }
+
+        void reset()
+        {
+            *this = statistics();
+        }
+    };
+
+    /*!
+    * \brief statistics of a container, kept up to date as elements are appended.
+    *
+    * Appended elements are folded in on the next query in O(1) each. If the
+    * container shrinks, or a watched generation advances, the statistics are
+    * recomputed from scratch; without one, call rebuild() after modifying
+    * elements in place.
+    */
+    template<typename T>
+    class running_stats : public lane_observer<running_stats<T>, T>
+    {
+        // Friends
+        friend class lane_observer<running_stats<T>, T>;
+
+    public:
+        // Typedefs
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+
+        // Constructors & Destructors
+        explicit running_stats(const container_type& c) : lane_observer<running_stats<T>, T>(c)
+        {
+            this->sync();
+        };
+
+        // Methods
+        /*!
+        * \brief Returns the statistics of every element of the container.
+        */
+        const statistics<T>& summary()
+        {
+            this->sync();
+            return stats_;
+        }
+
+        std::uint64_t count() { return summary().count; }
+        double mean() { return summary().mean; }
+        double variance() { return summary().variance(); }
+        double sample_variance() { return summary().sample_variance(); }
+        double standard_deviation() { return summary().standard_deviation(); }
+
+        /*!
+        * \brief Returns the smallest element. Throws std::out_of_range if the container is empty.
+        */
+        value_type min()
+        {
+            return nonempty().min;
+        }
+
+        /*!
+        * \brief Returns the largest element. Throws std::out_of_range if the container is empty.
+        */
+        value_type max()
+        {
+            return nonempty().max;
+        }
+
+        /*!
+        * \brief Folds the statistics of another container into these, which then describe both.
+        *
+        * Both are brought up to date first. The result no longer follows a
+        * single container and is detached from it.
+        */
+        void merge(running_stats& other)
+        {
+            this->sync();
+            stats_.merge(other.summary());
+            this->detach();
+        }
+
+    private:
+        statistics<T> stats_;
+
+        const statistics<T>& nonempty()
+        {
+            if (summary().count == 0)
+                throw std::out_of_range("std::out_of_range: running_stats of an empty container has no minimum or maximum.");
+            return stats_;
+        }
+
+        void absorb(size_t first, size_t last)
+        {
+            const container_type& c = *this->container();
+            for (size_t i = first; i < last; ++i) stats_.push(c[i]);
+        }
+
+        void reset()
+        {
+            stats_.reset();
+        }
+    };
+
+    /*!
+    * \brief Returns running_stats of the Nth container of type U in hv.
+    *
+    * The statistics watch hv.generation(), so they are recomputed after rows
+    * of hv are rewritten or removed in place.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    running_stats<U> make_running_stats(vector<T, Types...>& hv)
+    {
+        running_stats<U> result(hv.template get<U, N>());
+        result.watch(hv.generation());
+        return result;
+    }
+
+    // Algorithms
+    /*!
+    * \brief Returns the statistics of the Nth container of type U in hv, computed in one pass.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    statistics<U> describe(vector<T, Types...>& hv)
+    {
+        const std::vector<U>& c = hv.template get<U, N>();
+
+        statistics<U> result;
+        for (size_t i = 0; i < c.size(); ++i) result.push(c[i]);
+        return result;
+    }
+
+    /*!
+    * \brief Same as describe() but computes the statistics of blocks in parallel and merges them.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    statistics<U> describe(vector<T, Types...>& hv, parallel_policy)
+    {
+        const std::vector<U>& c = hv.template get<U, N>();
+
+        const size_t blocks = std::min(c.size() / (size_t(1) << 16), detail::concurrency());
+        if (blocks <= 1) return describe<U, N>(hv);
+
+        std::vector<statistics<U> > partial(blocks);
+        detail::parallel_for(blocks, 1, [&](size_t first, size_t last)
+        {
+            for (size_t b = first; b < last; ++b)
+            {
+                for (size_t i = c.size() * b / blocks; i < c.size() * (b + 1) / blocks; ++i) partial[b].push(c[i]);
+            }
+        });
+
+        statistics<U> result;
+        for (size_t b = 0; b < blocks; ++b) result.merge(partial[b]);
+        return result;
+    }
+
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    statistics<U> describe(vector<T, Types...>& hv, sequential_policy)
+    {
+        return describe<U, N>(hv);
+    }
+}
+
+#endif // HETEROGENEOUS_STATISTICS
@@ -0,0 +1,305 @@
+#ifndef HETEROGENEOUS_TIMESERIES
+#define HETEROGENEOUS_TIMESERIES
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file timeseries.hpp
+*
+* Time series over a heterogeneous::vector whose first container holds
+* timestamps and the others the values recorded at those times. Rows are
+* kept in timestamp order so that time ranges are found by binary search
+* and window aggregates are computed in a single pass.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "rows.hpp"
+#include "sort.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Rows [first, last) of a vector.
+    */
+    struct row_range
+    {
+        size_t first;
+        size_t last;
+
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        template<typename T>
+        T bucket_start(T t, T width, std::true_type /*integral*/)
+        {
+            // rounds towards negative infinity, unlike the % operator
+            T r = t % width;
+            if (r < 0) r += width;
+            return t - r;
+        }
+
+        template<typename T>
+        T bucket_start(T t, T width, std::false_type)
+        {
+            return static_cast<T>(std::floor(t / width) * width);
+        }
+
+        /*!
+        * \brief Writes to out[i] the extreme by cmp of values over the rows j with time[i] - width < time[j] <= time[i].
+        *
+        * The candidates are kept in a monotonic deque: each row enters and
+        * leaves it once, so the pass is linear in the number of rows.
+        */
+        template<typename T, typename U, typename Compare>
+        void sliding_extreme(const std::vector<T>& time, const std::vector<U>& values, T width, Compare cmp, std::vector<U>& out)
+        {
+            out.resize(values.size());
+
+            std::deque<size_t> candidates;
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                while (!candidates.empty() && !cmp(values[candidates.back()], values[i])) candidates.pop_back();
+                candidates.push_back(i);
+
+                // row i itself always stays, even if time[i] - time[i] is NaN for infinite timestamps
+                while (candidates.size() > 1 && !(time[i] - time[candidates.front()] < width)) candidates.pop_front();
+                out[i] = values[candidates.front()];
+            }
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief Time ordered view of a vector whose first container of type T holds timestamps.
+    *
+    * T must be arithmetic, for instance nanoseconds since the epoch as an
+    * integer or seconds as a double; NaN timestamps are rejected. Rows must
+    * be appended through append() for the order to be kept; rows of the
+    * vector are otherwise unchanged.
+    */
+    template<typename T, typename... Types>
+    class time_series
+    {
+        static_assert(std::is_arithmetic<T>::value, "heterogeneous::time_series requires an arithmetic timestamp type.");
+
+    public:
+        // Typedefs
+        typedef T time_type;
+        typedef heterogeneous::vector<T, Types...> vector_type;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Indexes the rows of hv by time, first sorting them stably by timestamp if they are out of order.
+        *
+        * If any timestamp is NaN, throws std::invalid_argument exception.
+        */
+        explicit time_series(vector_type& hv) : hv_(&hv)
+        {
+            const std::vector<T>& time = times();
+            for (const T& t : time) check_time(t);
+            if (rows(hv) != 0 && !std::is_sorted(time.begin(), time.end())) sort_rows<T, 0>(hv);
+        };
+
+        // Methods
+        /*!
+        * \brief Returns the timestamps, in ascending order.
+        */
+        const std::vector<T>& times() const
+        {
+            return hv_->template get<T, 0>();
+        }
+
+        /*!
+        * \brief Returns the indexed vector.
+        */
+        vector_type& data() const
+        {
+            return *hv_;
+        }
+
+        /*!
+        * \brief Adds a row recorded at time t and returns its index.
+        *
+        * Rows arriving in time order are appended in O(1). A late row is
+        * inserted after every row with a timestamp not later than t, which
+        * moves the rows following it. If t is NaN, throws std::invalid_argument
+        * exception.
+        */
+        size_t append(const T& t, const Types&... values)
+        {
+            check_time(t);
+
+            const std::vector<T>& time = times();
+            if (time.empty() || !(t < time.back()))
+            {
+                hv_->push_back(t, values...);
+                return time.size() - 1;
+            }
+
+            const size_t pos = std::upper_bound(time.begin(), time.end(), t) - time.begin();
+            hv_->insert_row(pos, t, values...);
+            return pos;
+        }
+
+        /*!
+        * \brief Returns the rows with timestamps t, t0 <= t < t1, in O(log n).
+        */
+        row_range window(const T& t0, const T& t1) const
+        {
+            const std::vector<T>& time = times();
+
+            row_range result;
+            result.first = std::lower_bound(time.begin(), time.end(), t0) - time.begin();
+            result.last = t1 < t0 ? result.first : std::lower_bound(time.begin() + result.first, time.end(), t1) - time.begin();
+            return result;
+        }
+
+        /*!
+        * \brief Aggregates the Nth container of type U over consecutive, non-overlapping windows of width.
+        *
+        * Windows start at multiples of width. Returns the start and
+        * aggregate, by op, of each window holding at least one row.
+        */
+        template<typename U, size_t N = 0, typename BinaryOp = std::plus<U> >
+        std::vector<std::pair<T, U> > tumbling(const T& width, BinaryOp op = BinaryOp()) const
+        {
+            check_width(width);
+
+            const std::vector<T>& time = times();
+            const std::vector<U>& values = hv_->template get<U, N>();
+
+            std::vector<std::pair<T, U> > result;
+            for (size_t i = 0; i < time.size(); )
+            {
+                const T start = detail::bucket_start(time[i], width, std::is_integral<T>());
+
+                U acc = values[i];
+                for (++i; i < time.size() && time[i] - start < width; ++i) acc = op(acc, values[i]);
+                result.emplace_back(start, acc);
+            }
+            return result;
+        }
+
+        /*!
+        * \brief Returns, for each row i, the sum of the Nth container of type U over the rows j with time[i] - width < time[j] <= time[i].
+        *
+        * Computed in one pass: each row is added when it enters the trailing
+        * window and subtracted when it leaves.
+        */
+        template<typename U, size_t N = 0>
+        std::vector<U> sliding_sum(const T& width) const
+        {
+            check_width(width);
+
+            const std::vector<T>& time = times();
+            const std::vector<U>& values = hv_->template get<U, N>();
+
+            std::vector<U> result(values.size());
+            U sum = U();
+            for (size_t i = 0, first = 0; i < values.size(); ++i)
+            {
+                sum += values[i];
+                for (; first < i && !(time[i] - time[first] < width); ++first) sum -= values[first];
+                result[i] = sum;
+            }
+            return result;
+        }
+
+        /*!
+        * \brief Returns, for each row i, the mean of the Nth container of type U over the same trailing window as sliding_sum().
+        */
+        template<typename U, size_t N = 0>
+        std::vector<double> sliding_mean(const T& width) const
+        {
+            check_width(width);
+
+            const std::vector<T>& time = times();
+            const std::vector<U>& values = hv_->template get<U, N>();
+
+            std::vector<double> result(values.size());
+            double sum = 0.0;
+            for (size_t i = 0, first = 0; i < values.size(); ++i)
+            {
+                sum += static_cast<double>(values[i]);
+                for (; first < i && !(time[i] - time[first] < width); ++first) sum -= static_cast<double>(values[first]);
+                result[i] = sum / static_cast<double>(i + 1 - first);
+            }
+            return result;
+        }
+
+        /*!
+        * \brief Returns, for each row i, the minimum of the Nth container of type U over the same trailing window as sliding_sum().
+        */
+        template<typename U, size_t N = 0>
+        std::vector<U> sliding_min(const T& width) const
+        {
+            check_width(width);
+
+            std::vector<U> result;
+            detail::sliding_extreme(times(), hv_->template get<U, N>(), width, std::less<U>(), result);
+            return result;
+        }
+
+        /*!
+        * \brief Returns, for each row i, the maximum of the Nth container of type U over the same trailing window as sliding_sum().
+        */
+        template<typename U, size_t N = 0>
+        std::vector<U> sliding_max(const T& width) const
+        {
+            check_width(width);
+
+            std::vector<U> result;
+            detail::sliding_extreme(times(), hv_->template get<U, N>(), width, std::greater<U>(), result);
+            return result;
+        }
+
+    private:
+        vector_type* hv_;
+
+        static void check_time(const T& t)
+        {
+            if (!(t == t))
+                throw std::invalid_argument("std::invalid_argument: time_series timestamp must not be NaN.");
+        }
+
+        static void check_width(const T& width)
+        {
+            if (!(width > T()))
+                throw std::invalid_argument("std::invalid_argument: time_series window width must be greater than 0.");
+        }
+    };
+
+    /*!
+    * \brief Returns a time_series of hv, indexed by its first container.
+    */
+    template<typename T, typename... Types>
+    time_series<T, Types...> make_time_series(vector<T, Types...>& hv)
+    {
+        return time_series<T, Types...>(hv);
+    }
+}
+
+#endif // HETEROGENEOUS_TIMESERIES
@@ -0,0 +1,166 @@
+#ifndef HETEROGENEOUS_TRANSFORM
+#define HETEROGENEOUS_TRANSFORM
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file transform.hpp
+*
+* Per container results of a heterogeneous::vector: a function is applied
+* to every container and its results are returned as a std::tuple, in
+* container order, or combined into a single value. Containers may be
+* handled concurrently, one task each.
+*/
+
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        // number of containers before position I with the same element type
+        template<size_t I, typename... Types>
+        constexpr size_t occurrence_v()
+        {
+            const bool same[] = { std::is_same<typename type_pack<Types...>::template type_at_t<I>, Types>::value... };
+
+            size_t result = 0;
+            for (size_t i = 0; i < I; ++i) result += same[i] ? 1 : 0;
+            return result;
+        }
+
+        /*!
+        * \brief Returns the container at position I of hv.
+        */
+        template<size_t I, typename T, typename... Types>
+        auto& container_at(vector<T, Types...>& hv)
+        {
+            typedef typename vector<T, Types...>::template type_at_t<I> U;
+            return hv.template get<U, occurrence_v<I, T, Types...>()>();
+        }
+
+        template<size_t I, typename Function, typename Vector>
+        using lane_result_t = std::decay_t<decltype(std::declval<Function&>()(container_at<I>(std::declval<Vector&>())))>;
+
+        template<typename T, typename... Types, typename Function, size_t... I>
+        std::tuple<lane_result_t<I, Function, vector<T, Types...> >...> transform_lanes(vector<T, Types...>& hv, Function& fn, std::index_sequence<I...>)
+        {
+            // elements of a braced list are evaluated in order
+            return std::tuple<lane_result_t<I, Function, vector<T, Types...> >...>{ fn(container_at<I>(hv))... };
+        }
+
+        template<typename T, typename... Types, typename Function, size_t... I>
+        std::tuple<lane_result_t<I, Function, vector<T, Types...> >...> transform_lanes(vector<T, Types...>& hv, Function& fn, std::index_sequence<I...>, parallel_policy)
+        {
+            // results need not be default constructible: each task constructs its own
+            std::tuple<std::unique_ptr<lane_result_t<I, Function, vector<T, Types...> > >...> results;
+
+            std::vector<std::function<void()> > tasks;
+            tasks.reserve(sizeof...(I));
+            (void)expand{ 0, (tasks.push_back([&hv, &fn, &results]()
+            {
+                std::get<I>(results).reset(new lane_result_t<I, Function, vector<T, Types...> >(fn(container_at<I>(hv))));
+            }), 0)... };
+
+            parallel_invoke(tasks);
+
+            return std::tuple<lane_result_t<I, Function, vector<T, Types...> >...>{ std::move(*std::get<I>(results))... };
+        }
+
+        template<typename Result, typename Tuple, typename BinaryOp, size_t... I>
+        Result reduce_tuple(Result init, Tuple& results, BinaryOp& reduce_op, std::index_sequence<I...>)
+        {
+            (void)expand{ 0, (init = reduce_op(std::move(init), std::move(std::get<I>(results))), 0)... };
+            return init;
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Returns the std::tuple of fn(container) for each container of hv, in order.
+    *
+    * fn is called on the containers in order and must return a value, of
+    * any type, for each of them.
+    */
+    template<typename T, typename... Types, typename Function>
+    auto transform_lanes(vector<T, Types...>& hv, Function fn)
+    {
+        return detail::transform_lanes(hv, fn, std::index_sequence_for<T, Types...>());
+    }
+
+    /*!
+    * \brief Same as transform_lanes() but calls fn on the containers concurrently, one task each.
+    *
+    * fn must be safe to call from several threads at once on different
+    * containers. The first exception it throws is rethrown once every
+    * container has been handled.
+    */
+    template<typename T, typename... Types, typename Function>
+    auto transform_lanes(vector<T, Types...>& hv, parallel_policy, Function fn)
+    {
+        return detail::transform_lanes(hv, fn, std::index_sequence_for<T, Types...>(), par);
+    }
+
+    template<typename T, typename... Types, typename Function>
+    auto transform_lanes(vector<T, Types...>& hv, sequential_policy, Function fn)
+    {
+        return transform_lanes(hv, fn);
+    }
+
+    /*!
+    * \brief Returns init combined by reduce_op with transform_op(container) for each container of hv, in order.
+    *
+    * The result is reduce_op(...reduce_op(reduce_op(init, r0), r1)..., rn)
+    * with ri the result of transform_op on the container at position i.
+    */
+    template<typename T, typename... Types, typename Result, typename BinaryOp, typename UnaryOp>
+    Result transform_reduce_lanes(vector<T, Types...>& hv, Result init, BinaryOp reduce_op, UnaryOp transform_op)
+    {
+        hv.for_each([&init, &reduce_op, &transform_op](auto& C)
+        {
+            init = reduce_op(std::move(init), transform_op(C));
+        });
+        return init;
+    }
+
+    /*!
+    * \brief Same as transform_reduce_lanes() but evaluates transform_op on the containers concurrently.
+    *
+    * The results are then combined in container order on the calling
+    * thread, so reduce_op need be neither associative nor commutative.
+    */
+    template<typename T, typename... Types, typename Result, typename BinaryOp, typename UnaryOp>
+    Result transform_reduce_lanes(vector<T, Types...>& hv, Result init, parallel_policy, BinaryOp reduce_op, UnaryOp transform_op)
+    {
+        auto results = transform_lanes(hv, par, transform_op);
+        return detail::reduce_tuple(std::move(init), results, reduce_op, std::index_sequence_for<T, Types...>());
+    }
+
+    template<typename T, typename... Types, typename Result, typename BinaryOp, typename UnaryOp>
+    Result transform_reduce_lanes(vector<T, Types...>& hv, Result init, sequential_policy, BinaryOp reduce_op, UnaryOp transform_op)
+    {
+        return transform_reduce_lanes(hv, std::move(init), reduce_op, transform_op);
+    }
+}
+
+#endif // HETEROGENEOUS_TRANSFORM
@@ -0,0 +1,204 @@
+#ifndef HETEROGENEOUS_UNIQUE
+#define HETEROGENEOUS_UNIQUE
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file unique.hpp
+*
+* Hash based removal of duplicate rows of a heterogeneous::vector,
+* comparing either every container or a chosen set of them. The first
+* occurrence of each row is kept and row order is preserved; every
+* container is compacted consistently.
+*/
+
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "parallel.hpp"
+#include "rows.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        inline size_t hash_combine(size_t seed, size_t h)
+        {
+            return seed ^ (h + size_t(0x9e3779b97f4a7c15ULL) + (seed << 6) + (seed >> 2));
+        }
+
+        template<typename C>
+        void hash_rows(const C& c, std::vector<size_t>& hashes, size_t first, size_t last)
+        {
+            std::hash<typename C::value_type> hash;
+            for (size_t i = first; i < last; ++i) hashes[i] = hash_combine(hashes[i], hash(c[i]));
+        }
+
+        /*!
+        * \brief Keys rows on every container of hv.
+        */
+        template<typename T, typename... Types>
+        struct all_lanes
+        {
+            vector<T, Types...>* hv;
+
+            void hash(std::vector<size_t>& hashes, size_t first, size_t last) const
+            {
+                hv->for_each([&](const auto& C) { hash_rows(C, hashes, first, last); });
+            }
+
+            bool equal(size_t i, size_t j) const
+            {
+                return hv->all_of([i, j](const auto& C) { return C[i] == C[j]; });
+            }
+        };
+
+        /*!
+        * \brief Keys rows on the containers named by Lanes.
+        */
+        template<typename Vector, typename... Lanes>
+        struct some_lanes
+        {
+            Vector* hv;
+
+            void hash(std::vector<size_t>& hashes, size_t first, size_t last) const
+            {
+                int expand[] = { 0, (hash_rows(hv->template get<typename Lanes::value_type, Lanes::index>(), hashes, first, last), 0)... };
+                (void)expand;
+            }
+
+            bool equal(size_t i, size_t j) const
+            {
+                bool result = true;
+                int expand[] = { 0, (result = result && equal_in(hv->template get<typename Lanes::value_type, Lanes::index>(), i, j), 0)... };
+                (void)expand;
+                return result;
+            }
+
+            template<typename C>
+            static bool equal_in(const C& c, size_t i, size_t j)
+            {
+                return c[i] == c[j];
+            }
+        };
+
+        template<typename Key>
+        struct row_hash
+        {
+            const std::vector<size_t>* hashes;
+            size_t operator()(size_t i) const { return (*hashes)[i]; }
+        };
+
+        template<typename Key>
+        struct row_equal
+        {
+            const Key* key;
+            bool operator()(size_t i, size_t j) const { return key->equal(i, j); }
+        };
+
+        template<typename Key>
+        using row_set = std::unordered_set<size_t, row_hash<Key>, row_equal<Key> >;
+
+        /*!
+        * \brief Sets keep[i] to 1 for the first row of each distinct key, 0 for later duplicates.
+        */
+        template<typename Key>
+        void first_occurrences(const Key& key, size_t n, std::vector<std::uint8_t>& keep, sequential_policy)
+        {
+            std::vector<size_t> hashes(n, 0);
+            key.hash(hashes, 0, n);
+
+            row_set<Key> seen(n, row_hash<Key>{ &hashes }, row_equal<Key>{ &key });
+            for (size_t i = 0; i < n; ++i) keep[i] = seen.insert(i).second ? 1 : 0;
+        }
+
+        /*!
+        * \brief Same as above, partitioning rows by hash so that each partition is deduplicated by its own thread.
+        *
+        * Equal rows hash alike and so share a partition, which is scanned in row
+        * order; the result is the same as the sequential one.
+        */
+        template<typename Key>
+        void first_occurrences(const Key& key, size_t n, std::vector<std::uint8_t>& keep, parallel_policy)
+        {
+            const size_t partitions = concurrency();
+            if (partitions == 1 || n < (size_t(1) << 16)) return first_occurrences(key, n, keep, seq);
+
+            std::vector<size_t> hashes(n, 0);
+            parallel_for(n, size_t(1) << 14, [&](size_t first, size_t last) { key.hash(hashes, first, last); });
+
+            std::vector<std::vector<size_t> > members(partitions);
+            for (size_t i = 0; i < n; ++i) members[(hashes[i] >> 7) % partitions].push_back(i);
+
+            parallel_for(partitions, 1, [&](size_t first, size_t last)
+            {
+                for (size_t p = first; p < last; ++p)
+                {
+                    row_set<Key> seen(members[p].size(), row_hash<Key>{ &hashes }, row_equal<Key>{ &key });
+                    for (size_t i : members[p]) keep[i] = seen.insert(i).second ? 1 : 0;
+                }
+            });
+        }
+
+        template<typename Key, typename T, typename... Types, typename Policy>
+        size_t unique_rows(vector<T, Types...>& hv, const Key& key, Policy policy)
+        {
+            const size_t n = rows(hv);
+
+            std::vector<std::uint8_t> keep(n);
+            first_occurrences(key, n, keep, policy);
+
+            return n - keep_rows(hv, keep, policy);
+        }
+    }
+    /*!
+    * \endcond
+    */
+
+    // Algorithms
+    /*!
+    * \brief Removes every row of hv equal, in every container, to an earlier row.
+    *
+    * Returns the number of rows removed. Elements need std::hash and operator==.
+    * With par, large inputs are hash partitioned and deduplicated concurrently.
+    */
+    template<typename T, typename... Types, typename Policy = sequential_policy>
+    size_t unique_rows(vector<T, Types...>& hv, Policy policy = Policy())
+    {
+        return detail::unique_rows(hv, detail::all_lanes<T, Types...>{ &hv }, policy);
+    }
+
+    /*!
+    * \brief Removes every row of hv equal to an earlier row in the containers named by Lanes.
+    *
+    *     heterogeneous::unique_rows<lane<int>, lane<std::string, 1> >(hv);
+    */
+    template<typename Lane, typename... Lanes, typename T, typename... Types, typename Policy = sequential_policy>
+    size_t unique_rows(vector<T, Types...>& hv, Policy policy = Policy())
+    {
+        return detail::unique_rows(hv, detail::some_lanes<vector<T, Types...>, Lane, Lanes...>{ &hv }, policy);
+    }
+
+    /*!
+    * \brief Removes every row of hv whose element of the Nth container of type U appeared in an earlier row.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types, typename Policy = sequential_policy>
+    size_t unique(vector<T, Types...>& hv, Policy policy = Policy())
+    {
+        return unique_rows<lane<U, N> >(hv, policy);
+    }
+}
+
+#endif // HETEROGENEOUS_UNIQUE
@@ -0,0 +1,472 @@
+#ifndef HETEROGENEOUS_VIEW
+#define HETEROGENEOUS_VIEW
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file view.hpp
+*
+* Lazy view adaptors over the containers of a heterogeneous::vector.
+* Adaptors are chained with operator| and evaluated element by element
+* while iterating, so a filter | transform | take pipeline is a single
+* pass with no intermediate containers.
+*
+*     auto v = hv.get<double>() | view::filter(pred) | view::transform(fn);
+*     double total = std::accumulate(v.begin(), v.end(), 0.0);
+*
+* Views provide begin(), end() and value_type like the containers they
+* adapt, so they can be used inside the functions given to for_each,
+* all_of, any_of and none_of.
+*/
+
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+
+namespace heterogeneous
+{
+    namespace view
+    {
+        /*!
+        * \brief Base class identifying views, which are held by value when adapted.
+        */
+        struct view_base
+        {};
+
+        /*!
+        * \brief View of every element of a container, which is held by reference.
+        */
+        template<typename C>
+        class ref_view : public view_base
+        {
+        public:
+            // Typedefs
+            typedef decltype(std::begin(std::declval<C&>())) iterator;
+            typedef typename std::iterator_traits<iterator>::value_type value_type;
+
+            explicit ref_view(C& c) : container_(&c)
+            {};
+
+            iterator begin() const { return std::begin(*container_); }
+            iterator end() const { return std::end(*container_); }
+            bool empty() const { return begin() == end(); }
+
+        private:
+            C* container_;
+        };
+
+        /*!
+        * \cond Skip Doxygen documentation of implementation details.
+        */
+        namespace detail
+        {
+            template<typename R>
+            using view_of = typename std::conditional<
+                std::is_base_of<view_base, typename std::decay<R>::type>::value,
+                typename std::decay<R>::type,
+                ref_view<typename std::remove_reference<R>::type> >::type;
+
+            template<typename R>
+            view_of<R> all(R&& r, std::true_type)
+            {
+                return std::forward<R>(r);
+            }
+
+            template<typename R>
+            view_of<R> all(R&& r, std::false_type)
+            {
+                static_assert(std::is_lvalue_reference<R>::value, "Only containers which outlive the view can be adapted.");
+                return view_of<R>(r);
+            }
+        }
+
+        // operator| is found through these types by argument dependent lookup
+        template<typename Fn> struct filter_adaptor { Fn fn; };
+        template<typename Fn> struct transform_adaptor { Fn fn; };
+        struct take_adaptor { size_t n; };
+        /*!
+        * \endcond
+        */
+
+        /*!
+        * \brief Returns a view of every element of r.
+        */
+        template<typename R>
+        detail::view_of<R> all(R&& r)
+        {
+            return detail::all(std::forward<R>(r), std::is_base_of<view_base, typename std::decay<R>::type>());
+        }
+
+        /*!
+        * \brief Returns a view of every element of the Nth container of type U in hv.
+        */
+        template<typename U, size_t N = 0, typename T, typename... Types>
+        ref_view<std::vector<U> > lane(vector<T, Types...>& hv)
+        {
+            return ref_view<std::vector<U> >(hv.template get<U, N>());
+        }
+
+        /*!
+        * \brief View of the elements of V for which pred returns true.
+        */
+        template<typename V, typename Pred>
+        class filter_view : public view_base
+        {
+            typedef typename V::iterator base_iterator;
+
+        public:
+            class iterator
+            {
+            public:
+                // Typedefs
+                typedef std::forward_iterator_tag iterator_category;
+                typedef typename std::iterator_traits<base_iterator>::value_type value_type;
+                typedef typename std::iterator_traits<base_iterator>::difference_type difference_type;
+                typedef typename std::iterator_traits<base_iterator>::reference reference;
+                typedef typename std::iterator_traits<base_iterator>::pointer pointer;
+
+                iterator() : pred_(nullptr)
+                {};
+
+                iterator(base_iterator itr, base_iterator end, const Pred* pred) : itr_(itr), end_(end), pred_(pred)
+                {
+                    satisfy();
+                }
+
+                reference operator*() const { return *itr_; }
+
+                iterator& operator++()
+                {
+                    ++itr_;
+                    satisfy();
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator temp = *this;
+                    ++(*this);
+                    return temp;
+                }
+
+                bool operator==(const iterator& rhs) const { return itr_ == rhs.itr_; }
+                bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+
+            private:
+                base_iterator itr_;
+                base_iterator end_;
+                const Pred* pred_;
+
+                void satisfy()
+                {
+                    while (itr_ != end_ && !(*pred_)(*itr_)) ++itr_;
+                }
+            };
+
+            typedef typename iterator::value_type value_type;
+
+            filter_view(V base, Pred pred) : base_(std::move(base)), pred_(std::move(pred))
+            {};
+
+            iterator begin() const { return iterator(base_.begin(), base_.end(), &pred_); }
+            iterator end() const { return iterator(base_.end(), base_.end(), &pred_); }
+            bool empty() const { return begin() == end(); }
+
+        private:
+            V base_;
+            Pred pred_;
+        };
+
+        /*!
+        * \brief View of fn applied to each element of V.
+        */
+        template<typename V, typename Function>
+        class transform_view : public view_base
+        {
+            typedef typename V::iterator base_iterator;
+
+        public:
+            class iterator
+            {
+            public:
+                // Typedefs
+                typedef std::forward_iterator_tag iterator_category;
+                typedef decltype(std::declval<const Function&>()(*std::declval<base_iterator>())) reference;
+                typedef typename std::decay<reference>::type value_type;
+                typedef typename std::iterator_traits<base_iterator>::difference_type difference_type;
+                typedef void pointer;
+
+                iterator() : fn_(nullptr)
+                {};
+
+                iterator(base_iterator itr, const Function* fn) : itr_(itr), fn_(fn)
+                {};
+
+                reference operator*() const { return (*fn_)(*itr_); }
+
+                iterator& operator++()
+                {
+                    ++itr_;
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator temp = *this;
+                    ++itr_;
+                    return temp;
+                }
+
+                bool operator==(const iterator& rhs) const { return itr_ == rhs.itr_; }
+                bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+
+            private:
+                base_iterator itr_;
+                const Function* fn_;
+            };
+
+            typedef typename iterator::value_type value_type;
+
+            transform_view(V base, Function fn) : base_(std::move(base)), fn_(std::move(fn))
+            {};
+
+            iterator begin() const { return iterator(base_.begin(), &fn_); }
+            iterator end() const { return iterator(base_.end(), &fn_); }
+            bool empty() const { return base_.empty(); }
+
+        private:
+            V base_;
+            Function fn_;
+        };
+
+        /*!
+        * \brief View of the first n elements of V.
+        */
+        template<typename V>
+        class take_view : public view_base
+        {
+            typedef typename V::iterator base_iterator;
+
+        public:
+            class iterator
+            {
+            public:
+                // Typedefs
+                typedef std::forward_iterator_tag iterator_category;
+                typedef typename std::iterator_traits<base_iterator>::value_type value_type;
+                typedef typename std::iterator_traits<base_iterator>::difference_type difference_type;
+                typedef typename std::iterator_traits<base_iterator>::reference reference;
+                typedef typename std::iterator_traits<base_iterator>::pointer pointer;
+
+                iterator() : n_(0)
+                {};
+
+                iterator(base_iterator itr, base_iterator end, size_t n) : itr_(n == 0 ? end : itr), end_(end), n_(n)
+                {};
+
+                reference operator*() const { return *itr_; }
+
+                iterator& operator++()
+                {
+                    // jump straight to the end after the nth element rather than
+                    // advancing the base, which may scan (e.g. a filter_view)
+                    if (--n_ == 0) itr_ = end_;
+                    else ++itr_;
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator temp = *this;
+                    ++(*this);
+                    return temp;
+                }
+
+                bool operator==(const iterator& rhs) const { return itr_ == rhs.itr_; }
+                bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+
+            private:
+                base_iterator itr_;
+                base_iterator end_;
+                size_t n_;
+            };
+
+            typedef typename iterator::value_type value_type;
+
+            take_view(V base, size_t n) : base_(std::move(base)), n_(n)
+            {};
+
+            iterator begin() const { return iterator(base_.begin(), base_.end(), n_); }
+            iterator end() const { return iterator(base_.end(), base_.end(), 0); }
+            bool empty() const { return begin() == end(); }
+
+        private:
+            V base_;
+            size_t n_;
+        };
+
+        /*!
+        * \brief View of tuples of corresponding elements of Vs, as long as the shortest of them.
+        */
+        template<typename... Vs>
+        class zip_view : public view_base
+        {
+            typedef std::tuple<typename Vs::iterator...> base_iterators;
+
+        public:
+            class iterator
+            {
+            public:
+                // Typedefs
+                typedef std::forward_iterator_tag iterator_category;
+                typedef std::tuple<typename std::iterator_traits<typename Vs::iterator>::value_type...> value_type;
+                typedef std::tuple<typename std::iterator_traits<typename Vs::iterator>::reference...> reference;
+                typedef std::ptrdiff_t difference_type;
+                typedef void pointer;
+
+                iterator()
+                {};
+
+                explicit iterator(base_iterators itrs) : itrs_(itrs)
+                {};
+
+                reference operator*() const
+                {
+                    return dereference(std::index_sequence_for<Vs...>());
+                }
+
+                iterator& operator++()
+                {
+                    increment(std::index_sequence_for<Vs...>());
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator temp = *this;
+                    ++(*this);
+                    return temp;
+                }
+
+                // equal once any component is, so iteration stops at the shortest view
+                bool operator==(const iterator& rhs) const { return any_equal(rhs, std::index_sequence_for<Vs...>()); }
+                bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+
+            private:
+                base_iterators itrs_;
+
+                template<size_t... I>
+                reference dereference(std::index_sequence<I...>) const
+                {
+                    return reference(*std::get<I>(itrs_)...);
+                }
+
+                template<size_t... I>
+                void increment(std::index_sequence<I...>)
+                {
+                    int expand[] = { 0, (++std::get<I>(itrs_), 0)... };
+                    (void)expand;
+                }
+
+                template<size_t... I>
+                bool any_equal(const iterator& rhs, std::index_sequence<I...>) const
+                {
+                    bool result = false;
+                    int expand[] = { 0, (result = result || std::get<I>(itrs_) == std::get<I>(rhs.itrs_), 0)... };
+                    (void)expand;
+                    return result;
+                }
+            };
+
+            typedef typename iterator::value_type value_type;
+
+            explicit zip_view(Vs... bases) : bases_(std::move(bases)...)
+            {};
+
+            iterator begin() const { return begin(std::index_sequence_for<Vs...>()); }
+            iterator end() const { return end(std::index_sequence_for<Vs...>()); }
+            bool empty() const { return begin() == end(); }
+
+        private:
+            std::tuple<Vs...> bases_;
+
+            template<size_t... I>
+            iterator begin(std::index_sequence<I...>) const
+            {
+                return iterator(base_iterators(std::get<I>(bases_).begin()...));
+            }
+
+            template<size_t... I>
+            iterator end(std::index_sequence<I...>) const
+            {
+                return iterator(base_iterators(std::get<I>(bases_).end()...));
+            }
+        };
+
+        // Adaptors
+        /*!
+        * \brief Adaptor keeping the elements for which pred returns true.
+        */
+        template<typename Pred>
+        filter_adaptor<Pred> filter(Pred pred)
+        {
+            return filter_adaptor<Pred>{ std::move(pred) };
+        }
+
+        /*!
+        * \brief Adaptor replacing each element x by fn(x).
+        */
+        template<typename Function>
+        transform_adaptor<Function> transform(Function fn)
+        {
+            return transform_adaptor<Function>{ std::move(fn) };
+        }
+
+        /*!
+        * \brief Adaptor keeping the first n elements.
+        */
+        inline take_adaptor take(size_t n)
+        {
+            return take_adaptor{ n };
+        }
+
+        /*!
+        * \brief Returns a view of tuples of corresponding elements of each range.
+        */
+        template<typename... Rs>
+        zip_view<detail::view_of<Rs>...> zip(Rs&&... rs)
+        {
+            return zip_view<detail::view_of<Rs>...>(all(std::forward<Rs>(rs))...);
+        }
+
+        template<typename R, typename Pred>
+        filter_view<detail::view_of<R>, Pred> operator|(R&& r, filter_adaptor<Pred> a)
+        {
+            return filter_view<detail::view_of<R>, Pred>(all(std::forward<R>(r)), std::move(a.fn));
+        }
+
+        template<typename R, typename Function>
+        transform_view<detail::view_of<R>, Function> operator|(R&& r, transform_adaptor<Function> a)
+        {
+            return transform_view<detail::view_of<R>, Function>(all(std::forward<R>(r)), std::move(a.fn));
+        }
+
+        template<typename R>
+        take_view<detail::view_of<R> > operator|(R&& r, take_adaptor a)
+        {
+            return take_view<detail::view_of<R> >(all(std::forward<R>(r)), a.n);
+        }
+    }
+}
+
+#endif // HETEROGENEOUS_VIEW
@@ -0,0 +1,789 @@
+#ifndef HETEROGENEOUS_WAL
+#define HETEROGENEOUS_WAL
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file wal.hpp
+*
+* logged_vector, a heterogeneous::vector made durable by a write-ahead
+* log: row appends and element changes are recorded in a compact binary
+* log, made durable by group commit, and folded into snapshots of the
+* whole vector. Opening a logged_vector recovers its state by reading the
+* last snapshot and replaying the log onto it.
+*
+* Containers may hold trivially copyable elements or std::strings.
+* Files use the byte order of the machine writing them.
+*/
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32)
+#include <io.h>
+// keep windows.h from defining min and max macros, which break std::min, std::max and numeric_limits
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../heterogeneous.hpp"
+#include "rows.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \cond Skip Doxygen documentation of implementation details.
+    */
+    namespace detail
+    {
+        /*!
+        * \brief True for element types logged_vector can write: trivially copyable types and std::string.
+        */
+        template<typename U>
+        struct is_loggable : std::integral_constant<bool, std::is_trivially_copyable<U>::value || std::is_same<U, std::string>::value>
+        {};
+
+        template<typename... Types>
+        constexpr bool all_loggable()
+        {
+            const bool loggable[] = { is_loggable<Types>::value... };
+            for (bool b : loggable) if (!b) return false;
+            return true;
+        }
+
+        inline void wal_error(const std::string& what)
+        {
+            throw std::runtime_error(std::string("std::runtime_error: ") + what);
+        }
+
+        /*!
+        * \brief Descriptor of a file opened for appending, made durable by sync().
+        */
+        class log_file
+        {
+        public:
+            // Constructors & Destructors
+            explicit log_file(const std::string& path) : path_(path)
+            {
+#if defined(_WIN32)
+                fd_ = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+                fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+                if (fd_ < 0) wal_error("Cannot open " + path + ".");
+            };
+
+            ~log_file()
+            {
+#if defined(_WIN32)
+                _close(fd_);
+#else
+                ::close(fd_);
+#endif
+            };
+
+            log_file(const log_file&) = delete;
+            log_file& operator=(const log_file&) = delete;
+
+            // Methods
+            void write(const char* data, size_t n)
+            {
+                while (n > 0)
+                {
+#if defined(_WIN32)
+                    const int written = _write(fd_, data, static_cast<unsigned>(n < 0x40000000 ? n : 0x40000000));
+#else
+                    const ssize_t written = ::write(fd_, data, n);
+                    if (written < 0 && errno == EINTR) continue;
+#endif
+                    if (written <= 0) wal_error("Cannot write " + path_ + ".");
+                    data += written;
+                    n -= static_cast<size_t>(written);
+                }
+            }
+
+            /*!
+            * \brief Returns once everything written has reached the storage device.
+            */
+            void sync()
+            {
+#if defined(_WIN32)
+                const int result = _commit(fd_);
+#else
+                const int result = ::fsync(fd_);
+#endif
+                if (result != 0) wal_error("Cannot sync " + path_ + ".");
+            }
+
+            void truncate(size_t n)
+            {
+#if defined(_WIN32)
+                const int result = _chsize_s(fd_, static_cast<long long>(n));
+#else
+                const int result = ::ftruncate(fd_, static_cast<off_t>(n));
+#endif
+                if (result != 0) wal_error("Cannot truncate " + path_ + ".");
+            }
+
+        private:
+            std::string path_;
+            int fd_;
+        };
+
+        /*!
+        * \brief Reads the file at path into out. Returns false if there is no such file.
+        */
+        inline bool read_file(const std::string& path, std::string& out)
+        {
+            std::ifstream in(path.c_str(), std::ios::binary);
+            if (!in) return false;
+
+            in.seekg(0, std::ios::end);
+            out.resize(static_cast<size_t>(in.tellg()));
+            in.seekg(0, std::ios::beg);
+            if (!out.empty() && !in.read(&out[0], static_cast<std::streamsize>(out.size()))) wal_error("Cannot read " + path + ".");
+            return true;
+        }
+
+        /*!
+        * \brief Makes the creation or renaming of the file at path durable by syncing its directory.
+        *
+        * Windows has no directory handle to sync; there MOVEFILE_WRITE_THROUGH
+        * covers renames instead.
+        */
+        inline void sync_directory(const std::string& path)
+        {
+#if !defined(_WIN32)
+            const size_t slash = path.find_last_of('/');
+            const std::string directory = slash == std::string::npos ? std::string(".") : path.substr(0, slash + 1);
+            const int fd = ::open(directory.c_str(), O_RDONLY);
+            if (fd >= 0)
+            {
+                ::fsync(fd);
+                ::close(fd);
+            }
+#else
+            (void)path;
+#endif
+        }
+
+        /*!
+        * \brief Durably replaces the file at path with data: data goes to a temporary file, synced, then renamed over path.
+        *
+        * A crash leaves either the former file or the new one, never a mix.
+        */
+        inline void replace_file(const std::string& path, const std::string& data)
+        {
+            const std::string temp = path + ".tmp";
+            std::remove(temp.c_str());
+            {
+                log_file f(temp);
+                f.write(data.data(), data.size());
+                f.sync();
+            }
+
+#if defined(_WIN32)
+            if (!MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) wal_error("Cannot rename " + temp + ".");
+#else
+            if (std::rename(temp.c_str(), path.c_str()) != 0) wal_error("Cannot rename " + temp + ".");
+
+            // the rename itself is durable once the directory is
+            sync_directory(path);
+#endif
+        }
+
+        // FNV-1a
+        inline std::uint64_t checksum(const char* data, size_t n)
+        {
+            std::uint64_t h = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < n; ++i) h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ull;
+            return h;
+        }
+
+        template<typename P>
+        void put(std::string& out, const P& value)
+        {
+            out.append(reinterpret_cast<const char*>(&value), sizeof(P));
+        }
+
+        inline void put(std::string& out, const std::string& value)
+        {
+            put(out, static_cast<std::uint64_t>(value.size()));
+            out.append(value);
+        }
+
+        template<typename U>
+        void put_lane(std::string& out, const std::vector<U>& c, size_t first)
+        {
+            put(out, static_cast<std::uint64_t>(c.size() - first));
+            if (c.size() > first) out.append(reinterpret_cast<const char*>(c.data() + first), (c.size() - first) * sizeof(U));
+        }
+
+        inline void put_lane(std::string& out, const std::vector<bool>& c, size_t first)
+        {
+            put(out, static_cast<std::uint64_t>(c.size() - first));
+            for (size_t i = first; i < c.size(); ++i) put(out, static_cast<bool>(c[i]));
+        }
+
+        inline void put_lane(std::string& out, const std::vector<std::string>& c, size_t first)
+        {
+            put(out, static_cast<std::uint64_t>(c.size() - first));
+            for (size_t i = first; i < c.size(); ++i) put(out, c[i]);
+        }
+
+        /*!
+        * \brief Reads values from a buffer whose checksum matched; running short means the file is corrupt.
+        */
+        class wal_reader
+        {
+        public:
+            wal_reader(const char* first, const char* last) : first_(first), last_(last)
+            {};
+
+            size_t left() const { return static_cast<size_t>(last_ - first_); }
+
+            const char* take(size_t n)
+            {
+                if (n > left()) wal_error("Log or snapshot is corrupt.");
+                const char* result = first_;
+                first_ += n;
+                return result;
+            }
+
+            template<typename P>
+            void get(P& value)
+            {
+                std::memcpy(&value, take(sizeof(P)), sizeof(P));
+            }
+
+            void get(std::string& value)
+            {
+                std::uint64_t n;
+                get(n);
+                value.assign(take(static_cast<size_t>(n)), static_cast<size_t>(n));
+            }
+
+            template<typename U>
+            void get_lane(std::vector<U>& c)
+            {
+                std::uint64_t n;
+                get(n);
+                const size_t first = c.size();
+                const char* data = take(static_cast<size_t>(n) * sizeof(U));
+                c.resize(first + static_cast<size_t>(n));
+                if (n > 0) std::memcpy(c.data() + first, data, static_cast<size_t>(n) * sizeof(U));
+            }
+
+            void get_lane(std::vector<bool>& c)
+            {
+                std::uint64_t n;
+                get(n);
+                for (std::uint64_t i = 0; i < n; ++i)
+                {
+                    bool b;
+                    get(b);
+                    c.push_back(b);
+                }
+            }
+
+            void get_lane(std::vector<std::string>& c)
+            {
+                std::uint64_t n;
+                get(n);
+                c.reserve(c.size() + static_cast<size_t>(n));
+                for (std::uint64_t i = 0; i < n; ++i)
+                {
+                    c.emplace_back();
+                    get(c.back());
+                }
+            }
+
+        private:
+            const char* first_;
+            const char* last_;
+        };
+
+        // kind of each container and size of its elements, checked when reading files back
+        template<typename T, typename... Types>
+        std::string wal_layout()
+        {
+            std::string result;
+            (void)expand{ 0, (put(result, static_cast<std::uint8_t>(std::is_same<T, std::string>::value)), put(result, static_cast<std::uint32_t>(sizeof(T))), 0),
+                (put(result, static_cast<std::uint8_t>(std::is_same<Types, std::string>::value)), put(result, static_cast<std::uint32_t>(sizeof(Types))), 0)... };
+            return result;
+        }
+
+        const char snapshot_magic[8] = { 'H', 'E', 'T', 'S', 'N', 'A', 'P', '1' };
+        const char log_magic[8] = { 'H', 'E', 'T', 'W', 'A', 'L', '0', '1' };
+
+        enum class wal_record : std::uint8_t
+        {
+            append = 1,     // rows appended to every container
+            assign = 2,     // element of a container overwritten
+            truncate = 3    // rows removed from the end of every container
+        };
+    }
+    /*!
+    * \endcond
+    */
+
+    /*!
+    * \brief heterogeneous::vector<T, Types...> whose changes are recorded in a write-ahead log, recovered on opening.
+    *
+    * Each change is applied in memory and appended to a log buffer under a
+    * lock, and given a log sequence number. commit() makes every change
+    * made so far durable: concurrent committers share a single write and
+    * fsync (_commit on Windows) of everything buffered, so that many small
+    * changes cost one flush. Changes not committed may be lost in a crash.
+    *
+    * checkpoint() writes a snapshot of the whole vector to a temporary file
+    * renamed over path + ".snap", then empties the log; it also runs from
+    * commit() once the log exceeds checkpoint_bytes. Opening replays the
+    * records of path + ".wal" newer than the snapshot onto it; a record
+    * torn by a crash ends the log and is discarded.
+    */
+    template<typename T, typename... Types>
+    class logged_vector
+    {
+        static_assert(detail::all_loggable<T, Types...>(), "logged_vector containers must hold trivially copyable elements or std::strings.");
+
+    public:
+        // Typedefs
+        typedef vector<T, Types...> vector_type;
+        typedef std::uint64_t lsn_type;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Opens the logged vector stored at path, recovering its contents, or creates an empty one.
+        *
+        * If the files were written for containers of other types, throws
+        * std::invalid_argument exception.
+        */
+        explicit logged_vector(const std::string& path, size_t checkpoint_bytes = size_t(64) << 20) : path_(path), checkpoint_bytes_(checkpoint_bytes), last_lsn_(0), durable_lsn_(0), log_bytes_(0), flushing_(false), failed_(false)
+        {
+            recover();
+            log_.reset(new detail::log_file(log_path()));
+            durable_lsn_ = last_lsn_;
+        };
+
+        /*!
+        * \brief Commits outstanding changes, ignoring errors, which a destructor cannot report.
+        */
+        ~logged_vector()
+        {
+            try
+            {
+                commit();
+            }
+            catch (...)
+            {}
+        };
+
+        logged_vector(const logged_vector&) = delete;
+        logged_vector& operator=(const logged_vector&) = delete;
+
+        // Methods
+        /*!
+        * \brief Appends a row: value to the first container, rest to the following ones in order. Returns its log sequence number.
+        */
+        lsn_type push_back(const T& value, const Types&... rest)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            check();
+
+            const size_t first = data_.template get<T, 0>().size();
+            data_.push_back(value, rest...);
+            return log_rows(first);
+        }
+
+        /*!
+        * \brief Appends every row of rows, as one record. Returns its log sequence number.
+        *
+        * rows must hold the same number of elements in every container.
+        */
+        lsn_type append(vector_type& rows)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            check();
+            heterogeneous::rows(rows);
+
+            const size_t first = data_.template get<T, 0>().size();
+            data_.for_each(rows, [](auto& C, auto& R) { C.insert(C.end(), R.begin(), R.end()); });
+            return log_rows(first);
+        }
+
+        /*!
+        * \brief Overwrites the element of row i in the Nth container of type U. Returns the log sequence number of the change.
+        *
+        * If there is no row i, throws std::out_of_range exception.
+        */
+        template<typename U, size_t N = 0>
+        lsn_type assign(size_t i, const U& value)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            check();
+
+            auto& c = data_.template get<U, N>();
+            if (i >= c.size()) missing_row(i, c.size());
+            c[i] = value;
+
+            std::string body = begin_record(detail::wal_record::assign);
+            detail::put(body, static_cast<std::uint32_t>(vector_type::template index_of_v<U, N>));
+            detail::put(body, static_cast<std::uint64_t>(i));
+            detail::put(body, value);
+            return end_record(body);
+        }
+
+        /*!
+        * \brief Removes the rows from row n on. Returns the log sequence number of the change.
+        *
+        * If there are fewer than n rows, throws std::out_of_range exception.
+        */
+        lsn_type truncate(size_t n)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            check();
+
+            const size_t rows = data_.template get<T, 0>().size();
+            if (n > rows) missing_row(n, rows);
+            data_.for_each([n](auto& C) { C.erase(C.begin() + n, C.end()); });
+
+            std::string body = begin_record(detail::wal_record::truncate);
+            detail::put(body, static_cast<std::uint64_t>(n));
+            return end_record(body);
+        }
+
+        /*!
+        * \brief Calls fn(const vector_type&) while no change can be made, and returns its result.
+        */
+        template<typename Function>
+        decltype(auto) read(Function fn)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return fn(static_cast<const vector_type&>(data_));
+        }
+
+        /*!
+        * \brief Returns once every change made before the call is durable.
+        *
+        * The first waiting thread writes and syncs everything buffered, on
+        * behalf of every thread waiting meanwhile; those wait for it rather
+        * than syncing again. If writing fails, throws std::runtime_error
+        * exception, as does every later change or commit.
+        */
+        void commit()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const lsn_type target = last_lsn_;
+
+            // fails even with nothing pending, as a failed flush may have lost earlier changes
+            check();
+            while (durable_lsn_ < target)
+            {
+                check();
+                if (flushing_)
+                {
+                    flushed_.wait(lock);
+                    continue;
+                }
+
+                flushing_ = true;
+                std::string batch;
+                batch.swap(buffer_);
+                const lsn_type upto = last_lsn_;
+
+                lock.unlock();
+                try
+                {
+                    log_->write(batch.data(), batch.size());
+                    log_->sync();
+                }
+                catch (...)
+                {
+                    lock.lock();
+                    failed_ = true;
+                    flushing_ = false;
+                    flushed_.notify_all();
+                    throw;
+                }
+                lock.lock();
+
+                flushing_ = false;
+                durable_lsn_ = upto;
+                log_bytes_ += batch.size();
+                flushed_.notify_all();
+            }
+
+            if (checkpoint_bytes_ != 0 && log_bytes_ >= checkpoint_bytes_ && !flushing_) write_snapshot();
+        }
+
+        /*!
+        * \brief Writes a snapshot of the vector and empties the log, making every change so far durable.
+        *
+        * Changes wait until the snapshot is written.
+        */
+        void checkpoint()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            flushed_.wait(lock, [this]() { return !flushing_; });
+            check();
+
+            write_snapshot();
+        }
+
+        /*!
+        * \brief Returns the log sequence number of the last change.
+        */
+        lsn_type last_lsn()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return last_lsn_;
+        }
+
+        /*!
+        * \brief Returns the log sequence number of the last durable change.
+        */
+        lsn_type durable_lsn()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return durable_lsn_;
+        }
+
+        /*!
+        * \brief Returns the number of bytes written to the log since the last snapshot.
+        */
+        size_t log_bytes()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return log_bytes_;
+        }
+
+    private:
+        std::string path_;
+        size_t checkpoint_bytes_;
+        vector_type data_;
+        std::unique_ptr<detail::log_file> log_;
+        std::string buffer_;    // records not yet written, in order
+        lsn_type last_lsn_;
+        lsn_type durable_lsn_;
+        size_t log_bytes_;
+        bool flushing_;
+        bool failed_;
+        std::mutex mutex_;
+        std::condition_variable flushed_;
+
+        std::string log_path() const { return path_ + ".wal"; }
+        std::string snapshot_path() const { return path_ + ".snap"; }
+
+        static std::string header(const char (&magic)[8])
+        {
+            std::string result(magic, sizeof(magic));
+            const std::string layout = detail::wal_layout<T, Types...>();
+            detail::put(result, static_cast<std::uint32_t>(layout.size()));
+            return result + layout;
+        }
+
+        void check() const
+        {
+            if (failed_) detail::wal_error("Log of " + path_ + " failed; changes can no longer be made durable.");
+        }
+
+        static void missing_row(size_t i, size_t rows)
+        {
+            throw std::out_of_range(std::string("std::out_of_range: Row ") + std::to_string(i) + std::string(" does not exist in logged_vector with ") + std::to_string(rows) + std::string(" rows."));
+        }
+
+        std::string begin_record(detail::wal_record kind)
+        {
+            std::string body;
+            detail::put(body, kind);
+            detail::put(body, ++last_lsn_);
+            return body;
+        }
+
+        // frames body with its size and checksum, so that a torn record is detected
+        lsn_type end_record(const std::string& body)
+        {
+            detail::put(buffer_, static_cast<std::uint32_t>(body.size()));
+            detail::put(buffer_, detail::checksum(body.data(), body.size()));
+            buffer_ += body;
+            return last_lsn_;
+        }
+
+        lsn_type log_rows(size_t first)
+        {
+            std::string body = begin_record(detail::wal_record::append);
+            data_.for_each([&body, first](const auto& C) { detail::put_lane(body, C, first); });
+            return end_record(body);
+        }
+
+        void write_snapshot()
+        {
+            std::string snapshot = header(detail::snapshot_magic);
+            detail::put(snapshot, last_lsn_);
+            data_.for_each([&snapshot](const auto& C) { detail::put_lane(snapshot, C, 0); });
+            detail::put(snapshot, detail::checksum(snapshot.data(), snapshot.size()));
+
+            detail::replace_file(snapshot_path(), snapshot);
+
+            // records still in the log are older than the snapshot, so a crash before this point is harmless
+            try
+            {
+                log_->truncate(header(detail::log_magic).size());
+                log_->sync();
+            }
+            catch (...)
+            {
+                failed_ = true;
+                throw;
+            }
+
+            buffer_.clear();
+            durable_lsn_ = last_lsn_;
+            log_bytes_ = 0;
+        }
+
+        void recover()
+        {
+            lsn_type snapshot_lsn = 0;
+
+            std::string snapshot;
+            if (detail::read_file(snapshot_path(), snapshot))
+            {
+                const std::string expected = header(detail::snapshot_magic);
+                if (snapshot.compare(0, expected.size(), expected) != 0)
+                    throw std::invalid_argument("std::invalid_argument: Snapshot " + snapshot_path() + " does not hold containers of these types.");
+                if (snapshot.size() < expected.size() + 16 || detail::checksum(snapshot.data(), snapshot.size() - 8) != tail_checksum(snapshot))
+                    detail::wal_error("Snapshot " + snapshot_path() + " is corrupt.");
+
+                detail::wal_reader in(snapshot.data() + expected.size(), snapshot.data() + snapshot.size() - 8);
+                in.get(snapshot_lsn);
+                data_.for_each([&in](auto& C) { in.get_lane(C); });
+            }
+            last_lsn_ = snapshot_lsn;
+
+            std::string log;
+            const std::string expected = header(detail::log_magic);
+            if (!detail::read_file(log_path(), log) || log.size() < expected.size())
+            {
+                // missing, or torn while its header was written; a new log only survives a crash once its directory entry does
+                detail::log_file f(log_path());
+                f.truncate(0);
+                f.write(expected.data(), expected.size());
+                f.sync();
+                detail::sync_directory(log_path());
+                return;
+            }
+            if (log.compare(0, expected.size(), expected) != 0)
+                throw std::invalid_argument("std::invalid_argument: Log " + log_path() + " does not hold containers of these types.");
+
+            size_t valid = expected.size();
+            while (log.size() - valid >= 12)
+            {
+                std::uint32_t size;
+                std::uint64_t sum;
+                std::memcpy(&size, log.data() + valid, 4);
+                std::memcpy(&sum, log.data() + valid + 4, 8);
+
+                const char* body = log.data() + valid + 12;
+                if (log.size() - valid - 12 < size || detail::checksum(body, size) != sum) break;
+
+                replay(body, size, snapshot_lsn);
+                valid += 12 + size;
+            }
+
+            // later records must follow the last complete one
+            log_bytes_ = valid - expected.size();
+            if (valid != log.size())
+            {
+                detail::log_file f(log_path());
+                f.truncate(valid);
+                f.sync();
+            }
+        }
+
+        static std::uint64_t tail_checksum(const std::string& file)
+        {
+            std::uint64_t result;
+            std::memcpy(&result, file.data() + file.size() - 8, 8);
+            return result;
+        }
+
+        void replay(const char* body, size_t size, lsn_type snapshot_lsn)
+        {
+            detail::wal_reader in(body, body + size);
+
+            detail::wal_record kind;
+            lsn_type lsn;
+            in.get(kind);
+            in.get(lsn);
+
+            last_lsn_ = lsn > last_lsn_ ? lsn : last_lsn_;
+            if (lsn <= snapshot_lsn) return;
+
+            switch (kind)
+            {
+            case detail::wal_record::append:
+                data_.for_each([&in](auto& C) { in.get_lane(C); });
+                break;
+
+            case detail::wal_record::assign:
+            {
+                std::uint32_t lane;
+                std::uint64_t row;
+                in.get(lane);
+                in.get(row);
+                data_.visit_lane(lane, [&in, row](auto& C)
+                {
+                    if (row >= C.size()) detail::wal_error("Log is corrupt.");
+                    typename std::decay_t<decltype(C)>::value_type value;
+                    in.get(value);
+                    C[static_cast<size_t>(row)] = value;
+                });
+                break;
+            }
+
+            case detail::wal_record::truncate:
+            {
+                std::uint64_t n;
+                in.get(n);
+                data_.for_each([n](auto& C) { if (n < C.size()) C.erase(C.begin() + static_cast<size_t>(n), C.end()); });
+                break;
+            }
+
+            default:
+                detail::wal_error("Log is corrupt.");
+            }
+        }
+    };
+}
+
+#endif // HETEROGENEOUS_WAL
@@ -0,0 +1,297 @@
+#ifndef HETEROGENEOUS_ZONE_MAP
+#define HETEROGENEOUS_ZONE_MAP
+
+/*
+* Distributed under the Boost Software License, Version 1.0.
+* (See accompanying file LICENSE_1_0.txt or copy at
+* http://www.boost.org/LICENSE_1_0.txt)
+*
+* Copyright (c) 2015 Hirotatsu Armstrong
+*/
+
+/*!
+* \file zone_map.hpp
+*
+* Per-block minimum/maximum summaries (zone maps) of a container of a
+* heterogeneous::vector, used to skip blocks which cannot satisfy a
+* range predicate.
+*/
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../heterogeneous.hpp"
+#include "observer.hpp"
+
+namespace heterogeneous
+{
+    /*!
+    * \brief Block counters accumulated by range scans over a zone_map.
+    */
+    struct scan_stats
+    {
+        size_t blocks_scanned;   //!< blocks whose elements were compared against the range
+        size_t blocks_skipped;   //!< blocks excluded by their min/max without being read
+        size_t blocks_matched;   //!< blocks lying entirely within the range, taken without comparisons
+        size_t elements_scanned; //!< elements compared against the range
+
+        scan_stats() : blocks_scanned(0), blocks_skipped(0), blocks_matched(0), elements_scanned(0)
+        {};
+
+        void reset()
+        {
+            *this = scan_stats();
+        }
+    };
+
+    /*!
+    * \brief Minimum and maximum of each fixed size block of a container.
+    *
+    * Elements appended to the container are folded into the summary on the
+    * next query. Only operator< and operator== of T are used.
+    */
+    template<typename T>
+    class zone_map : public lane_observer<zone_map<T>, T>
+    {
+        // Friends
+        friend class lane_observer<zone_map<T>, T>;
+
+    public:
+        // Typedefs
+        typedef T value_type;
+        typedef std::vector<T> container_type;
+
+        // Constructors & Destructors
+        /*!
+        * \brief Builds a zone map of c with blocks of block_size elements.
+        */
+        explicit zone_map(const container_type& c, size_t block_size = 1024)
+            : lane_observer<zone_map<T>, T>(c), block_size_(block_size)
+        {
+            if (block_size_ == 0)
+                throw std::invalid_argument("std::invalid_argument: zone_map block size must be greater than 0.");
+            this->sync();
+        };
+
+        // Methods
+        /*!
+        * \brief Returns the number of elements per block.
+        */
+        size_t block_size() const
+        {
+            return block_size_;
+        }
+
+        /*!
+        * \brief Returns the number of blocks.
+        */
+        size_t blocks()
+        {
+            this->sync();
+            return zones_.size();
+        }
+
+        /*!
+        * \brief Returns reference to the smallest element of block b.
+        */
+        const value_type& min(size_t b)
+        {
+            return zone(b).min;
+        }
+
+        /*!
+        * \brief Returns reference to the largest element of block b.
+        */
+        const value_type& max(size_t b)
+        {
+            return zone(b).max;
+        }
+
+        /*!
+        * \brief Returns false if no element of block b can lie within [lo, hi].
+        */
+        bool overlaps(size_t b, const value_type& lo, const value_type& hi)
+        {
+            const block& z = zone(b);
+            return !(z.max < lo || hi < z.min);
+        }
+
+        /*!
+        * \brief Returns true if every element of block b lies within [lo, hi].
+        */
+        bool covered(size_t b, const value_type& lo, const value_type& hi)
+        {
+            const block& z = zone(b);
+            return z.ordered && !(z.min < lo) && !(hi < z.max);
+        }
+
+        // Algorithms
+        /*!
+        * \brief Calls fn(i, element) for each element within [lo, hi], in order of index i.
+        */
+        template<typename Function>
+        Function filter(const value_type& lo, const value_type& hi, Function fn)
+        {
+            this->sync();
+            const container_type& c = *this->container();
+
+            for (size_t b = 0; b < zones_.size(); ++b)
+            {
+                const size_t first = b * block_size_;
+                const size_t last = std::min(first + block_size_, c.size());
+
+                if (!overlaps(b, lo, hi))
+                {
+                    ++stats_.blocks_skipped;
+                }
+                else if (covered(b, lo, hi))
+                {
+                    ++stats_.blocks_matched;
+                    for (size_t i = first; i < last; ++i) fn(i, c[i]);
+                }
+                else
+                {
+                    ++stats_.blocks_scanned;
+                    stats_.elements_scanned += last - first;
+                    for (size_t i = first; i < last; ++i)
+                    {
+                        if (within(c[i], lo, hi)) fn(i, c[i]);
+                    }
+                }
+            }
+
+            return fn;
+        }
+
+        /*!
+        * \brief Returns the number of elements within [lo, hi].
+        *
+        * Blocks lying entirely within the range are counted without being read.
+        */
+        size_t count(const value_type& lo, const value_type& hi)
+        {
+            this->sync();
+            const container_type& c = *this->container();
+
+            size_t n = 0;
+            for (size_t b = 0; b < zones_.size(); ++b)
+            {
+                const size_t first = b * block_size_;
+                const size_t last = std::min(first + block_size_, c.size());
+
+                if (!overlaps(b, lo, hi))
+                {
+                    ++stats_.blocks_skipped;
+                }
+                else if (covered(b, lo, hi))
+                {
+                    ++stats_.blocks_matched;
+                    n += last - first;
+                }
+                else
+                {
+                    ++stats_.blocks_scanned;
+                    stats_.elements_scanned += last - first;
+                    for (size_t i = first; i < last; ++i)
+                    {
+                        n += within(c[i], lo, hi) ? 1 : 0;
+                    }
+                }
+            }
+
+            return n;
+        }
+
+        /*!
+        * \brief Returns init plus the sum of all elements within [lo, hi].
+        */
+        template<typename R>
+        R sum(const value_type& lo, const value_type& hi, R init)
+        {
+            filter(lo, hi, [&init](size_t, const value_type& v) { init += v; });
+            return init;
+        }
+
+        /*!
+        * \brief Returns counters accumulated by filter(), count() and sum().
+        */
+        const scan_stats& stats() const
+        {
+            return stats_;
+        }
+
+        void reset_stats()
+        {
+            stats_.reset();
+        }
+
+    private:
+        struct block
+        {
+            value_type min;
+            value_type max;
+            bool ordered; // false once an element unequal to itself (NaN) was seen
+        };
+
+        size_t block_size_;
+        std::vector<block> zones_;
+        scan_stats stats_;
+
+        static bool within(const value_type& v, const value_type& lo, const value_type& hi)
+        {
+            return !(v < lo) && !(hi < v) && v == v;
+        }
+
+        const block& zone(size_t b)
+        {
+            this->sync();
+            if (b >= zones_.size())
+                throw std::out_of_range(std::string("std::out_of_range: Block b=") + std::to_string(b) + std::string(" does not exist in zone_map."));
+            return zones_[b];
+        }
+
+        void absorb(size_t first, size_t last)
+        {
+            const container_type& c = *this->container();
+
+            for (size_t i = first; i < last; ++i)
+            {
+                const value_type& v = c[i];
+                if (i % block_size_ == 0)
+                {
+                    block z = { v, v, v == v };
+                    zones_.push_back(z);
+                    continue;
+                }
+
+                block& z = zones_.back();
+                if (v < z.min) z.min = v;
+                if (z.max < v) z.max = v;
+                if (!(v == v)) z.ordered = false;
+            }
+        }
+
+        void reset()
+        {
+            zones_.clear();
+        }
+    };
+
+    /*!
+    * \brief Returns a zone_map of the Nth container of type U in hv.
+    *
+    * The zone map watches hv.generation(), so it is rebuilt after rows of hv
+    * are rewritten or removed in place.
+    */
+    template<typename U, size_t N = 0, typename T, typename... Types>
+    zone_map<U> make_zone_map(vector<T, Types...>& hv, size_t block_size = 1024)
+    {
+        zone_map<U> result(hv.template get<U, N>(), block_size);
+        result.watch(hv.generation());
+        return result;
+    }
+}
+
+#endif // HETEROGENEOUS_ZONE_MAP